@@ -0,0 +1,376 @@
+#include <ros/time.h>
+#include <nav_msgs/Odometry.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <tf/tf.h>
+
+#include <cslibs_math_ros/tf/tf_provider.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
+#include <cslibs_plugins_data/types/laserscan_convert.hpp>
+#include <cslibs_plugins_data/types/odometry_2d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_convert.hpp>
+
+#include "../src/odometry_2d_provider.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// allocation accounting, every block carries its size in front
+namespace {
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> allocated_bytes{0};
+std::atomic<std::size_t> freed_bytes{0};
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+inline void *allocate(const std::size_t size) {
+  void *block = std::malloc(size + header_size);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *static_cast<std::size_t *>(block) = size;
+  ++allocations;
+  allocated_bytes += size;
+  return static_cast<char *>(block) + header_size;
+}
+
+inline void deallocate(void *p) {
+  if (!p) {
+    return;
+  }
+  void *block = static_cast<char *>(p) - header_size;
+  freed_bytes += *static_cast<std::size_t *>(block);
+  std::free(block);
+}
+}  // namespace
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void *p) noexcept { deallocate(p); }
+void operator delete[](void *p) noexcept { deallocate(p); }
+void operator delete(void *p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void *p, std::size_t) noexcept { deallocate(p); }
+
+namespace {
+using steady_clock_t = std::chrono::steady_clock;
+
+/**
+ * @brief TF provider answering every request with a transform moving
+ *        linearly over time, so no tf tree is required.
+ */
+class StubTFProvider : public cslibs_math_ros::tf::TFProvider {
+ public:
+  using cslibs_math_ros::tf::TFProvider::lookupTransform;
+
+  bool lookupTransform(const std::string &, const std::string &,
+                       const ros::Time &time, tf::StampedTransform &transform,
+                       const ros::Duration & = ros::Duration(0.0)) {
+    transform = tf::StampedTransform(at(time), time, "", "");
+    return true;
+  }
+
+  bool lookupTransform(const std::string &, const std::string &,
+                       const ros::Time &time, tf::Transform &transform,
+                       const ros::Duration & = ros::Duration(0.0)) {
+    transform = at(time);
+    return true;
+  }
+
+  bool canTransform(const std::string &, const std::string &,
+                    const ros::Time &) {
+    return true;
+  }
+
+  bool waitForTransform(const std::string &, const std::string &,
+                        const ros::Time &, const ros::Duration &) {
+    return true;
+  }
+
+ private:
+  static tf::Transform at(const ros::Time &time) {
+    const double t = time.toSec();
+    return tf::Transform(tf::createQuaternionFromYaw(0.1 + 0.5 * t),
+                         tf::Vector3(0.2 + 1.0 * t, 0.05, 0.3));
+  }
+};
+
+struct Result {
+  double ns_per_item;
+  double allocations_per_message;
+  double bytes_per_data;
+};
+
+/**
+ * @brief Run a conversion repeatedly. The converted object is kept alive
+ *        until its retained heap size has been accounted.
+ * @param items       beams or points per message, for the per item timing
+ * @param iterations  amount of measured runs after one warm up run
+ * @param run         converts one message, returns the created object
+ */
+template <typename Run>
+Result measure(const std::size_t items, const std::size_t iterations,
+               Run &&run) {
+  run();
+
+  std::size_t allocs = 0;
+  std::size_t retained = 0;
+  steady_clock_t::duration elapsed{0};
+  for (std::size_t i = 0; i < iterations; ++i) {
+    const std::size_t allocs_before = allocations;
+    const std::size_t allocated_before = allocated_bytes;
+    const std::size_t freed_before = freed_bytes;
+
+    const steady_clock_t::time_point start = steady_clock_t::now();
+    auto data = run();
+    elapsed += steady_clock_t::now() - start;
+
+    allocs += allocations - allocs_before;
+    retained += (allocated_bytes - allocated_before) -
+                (freed_bytes - freed_before);
+    data.reset();
+  }
+
+  const double n = static_cast<double>(iterations);
+  return Result{
+      std::chrono::duration<double, std::nano>(elapsed).count() /
+          (n * static_cast<double>(std::max<std::size_t>(items, 1))),
+      static_cast<double>(allocs) / n, static_cast<double>(retained) / n};
+}
+
+void report(const std::string &name, const std::string &unit,
+            const Result &r) {
+  std::cout << std::left << std::setw(44) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(2)
+            << r.ns_per_item << " ns/" << std::setw(6) << std::left << unit
+            << std::right << std::setw(10) << std::setprecision(1)
+            << r.allocations_per_message << " allocs/msg" << std::setw(12)
+            << std::setprecision(0) << r.bytes_per_data << " bytes/Data"
+            << std::endl;
+}
+
+sensor_msgs::LaserScanConstPtr makeScan(const std::size_t beams) {
+  sensor_msgs::LaserScanPtr msg{new sensor_msgs::LaserScan};
+  msg->header.frame_id = "laser";
+  msg->header.stamp = ros::Time(100.0);
+  msg->angle_min = -static_cast<float>(M_PI) * 0.75f;
+  msg->angle_max = static_cast<float>(M_PI) * 0.75f;
+  msg->angle_increment =
+      (msg->angle_max - msg->angle_min) / static_cast<float>(beams - 1);
+  msg->scan_time = 0.025f;
+  msg->time_increment = msg->scan_time / static_cast<float>(beams);
+  msg->range_min = 0.05f;
+  msg->range_max = 30.0f;
+  msg->ranges.resize(beams);
+  msg->intensities.resize(beams);
+  for (std::size_t i = 0; i < beams; ++i) {
+    msg->intensities[i] = static_cast<float>(i % 255);
+    /// some beams out of range to exercise the invalid path
+    msg->ranges[i] =
+        (i % 17 == 0) ? 0.0f : 1.0f + 10.0f * static_cast<float>(i % 97) / 97.f;
+  }
+  return msg;
+}
+
+sensor_msgs::PointCloud2ConstPtr makeCloud(const uint32_t rows,
+                                           const uint32_t cols) {
+  sensor_msgs::PointCloud2Ptr msg{new sensor_msgs::PointCloud2};
+  msg->header.frame_id = "lidar";
+  msg->header.stamp = ros::Time(100.0);
+  msg->height = rows;
+  msg->width = cols;
+  msg->is_bigendian = false;
+  msg->is_dense = false;
+  msg->point_step = 16;
+  msg->row_step = msg->point_step * cols;
+  const char *names[] = {"x", "y", "z", "intensity"};
+  for (uint32_t f = 0; f < 4; ++f) {
+    sensor_msgs::PointField field;
+    field.name = names[f];
+    field.offset = 4 * f;
+    field.datatype = sensor_msgs::PointField::FLOAT32;
+    field.count = 1;
+    msg->fields.push_back(field);
+  }
+  msg->data.resize(msg->row_step * rows);
+  for (uint32_t r = 0; r < rows; ++r) {
+    const float elevation = -0.3f + 0.6f * static_cast<float>(r) / rows;
+    for (uint32_t c = 0; c < cols; ++c) {
+      const float azimuth = 2.f * static_cast<float>(M_PI) * c / cols;
+      const bool valid = (r * cols + c) % 13 != 0;
+      const float range = valid ? 2.f + 20.f * static_cast<float>(c % 31) / 31.f
+                                : std::numeric_limits<float>::quiet_NaN();
+      const float p[4] = {range * std::cos(elevation) * std::cos(azimuth),
+                          range * std::cos(elevation) * std::sin(azimuth),
+                          range * std::sin(elevation), 1.f};
+      std::memcpy(&msg->data[r * msg->row_step + c * msg->point_step], p,
+                  sizeof(p));
+    }
+  }
+  return msg;
+}
+
+nav_msgs::OdometryConstPtr makeOdometry(const std::size_t i) {
+  nav_msgs::OdometryPtr msg{new nav_msgs::Odometry};
+  msg->header.frame_id = "odom";
+  msg->header.stamp = ros::Time(100.0 + 0.01 * static_cast<double>(i));
+  msg->pose.pose.position.x = 0.01 * static_cast<double>(i);
+  msg->pose.pose.position.y = 0.002 * static_cast<double>(i);
+  msg->pose.pose.orientation =
+      tf::createQuaternionMsgFromYaw(0.001 * static_cast<double>(i));
+  return msg;
+}
+
+/// exposes the odometry callback and discards its output
+template <typename T>
+class OdometryBench : public cslibs_plugins_data::Odometry2DProviderBase<T> {
+ public:
+  using cslibs_plugins_data::Odometry2DProviderBase<T>::callback;
+};
+
+template <typename T>
+void benchmarkLaser(const std::string &type, const std::size_t beams,
+                    const std::size_t iterations) {
+  using scan_t = cslibs_plugins_data::types::Laserscan2<T>;
+  const auto msg = makeScan(beams);
+  const cslibs_plugins_data::types::interval_t<T> limits = {
+      T(), std::numeric_limits<T>::max()};
+  cslibs_math_ros::tf::TFProvider::Ptr tf{new StubTFProvider};
+  const std::string suffix =
+      "<" + type + "> " + std::to_string(beams) + " beams";
+
+  report("laser convert" + suffix, "beam",
+         measure(beams, iterations, [&]() {
+           typename scan_t::Ptr dst;
+           cslibs_plugins_data::types::convert<T>(msg, limits, dst, false);
+           return dst;
+         }));
+  report("laser convert intensities" + suffix, "beam",
+         measure(beams, iterations, [&]() {
+           typename scan_t::Ptr dst;
+           cslibs_plugins_data::types::convert<T>(msg, limits, dst, false,
+                                                  true);
+           return dst;
+         }));
+  report("laser convert tf" + suffix, "beam",
+         measure(beams, iterations, [&]() {
+           typename scan_t::Ptr dst;
+           cslibs_plugins_data::types::convert<T>(
+               msg, tf, "base_link", ros::Duration(0.1), limits, dst, false);
+           return dst;
+         }));
+  report("laser convertUndistorted" + suffix, "beam",
+         measure(beams, iterations, [&]() {
+           typename scan_t::Ptr dst;
+           cslibs_plugins_data::types::convertUndistorted<T>(
+               msg, tf, "odom", ros::Duration(0.1), dst);
+           return dst;
+         }));
+}
+
+template <typename T>
+void benchmarkCloud(const std::string &type, const uint32_t rows,
+                    const uint32_t cols, const std::size_t iterations,
+                    cslibs_plugins_data::common::WorkerPool *workers) {
+  using cloud_t = cslibs_math_3d::Pointcloud3<T>;
+  const auto msg = makeCloud(rows, cols);
+  const std::size_t points = static_cast<std::size_t>(rows) * cols;
+  cslibs_math_ros::tf::TFProvider::Ptr tf{new StubTFProvider};
+  cslibs_math_3d::Transform3<T> transform;
+  tf->lookupTransform("base_link", msg->header.frame_id, msg->header.stamp,
+                      transform, ros::Duration(0.1));
+  const std::string suffix = "<" + type + "> " + std::to_string(rows) + "x" +
+                             std::to_string(cols) +
+                             (workers ? " pool " + std::to_string(workers->size() + 1)
+                                      : std::string(" serial"));
+
+  report("pointcloud convert" + suffix, "point",
+         measure(points, iterations, [&]() {
+           typename cloud_t::Ptr dst;
+           cslibs_plugins_data::types::convert(
+               cslibs_plugins_data::types::Pointcloud3View<T>(msg), workers,
+               dst);
+           return dst;
+         }));
+  report("pointcloud convert tf" + suffix, "point",
+         measure(points, iterations, [&]() {
+           typename cloud_t::Ptr dst;
+           cslibs_plugins_data::types::convert(
+               cslibs_plugins_data::types::Pointcloud3View<T>(msg), transform,
+               workers, dst);
+           return dst;
+         }));
+}
+
+template <typename T>
+void benchmarkOdometry(const std::string &type, const std::size_t iterations) {
+  using odometry_t = cslibs_plugins_data::types::Odometry2<T>;
+  const cslibs_time::TimeFrame time_frame(
+      cslibs_time::Time(ros::Time(100.0).toNSec()),
+      cslibs_time::Time(ros::Time(100.1).toNSec()));
+  const odometry_t odometry(
+      "odom", time_frame, cslibs_math_2d::Transform2<T>(0.0, 0.0, 0.0),
+      cslibs_math_2d::Transform2<T>(0.1, 0.02, 0.05), time_frame.end);
+  const cslibs_time::Time split_time(ros::Time(100.05).toNSec());
+
+  report("odometry split<" + type + ">", "msg",
+         measure(1, iterations, [&]() {
+           typename odometry_t::ConstPtr a;
+           typename odometry_t::ConstPtr b;
+           odometry.split(split_time, a, b);
+           return a;
+         }));
+
+  OdometryBench<T> provider;
+  std::vector<nav_msgs::OdometryConstPtr> msgs;
+  for (std::size_t i = 0; i < iterations + 1; ++i) {
+    msgs.emplace_back(makeOdometry(i));
+  }
+  std::size_t i = 0;
+  report("odometry callback<" + type + ">", "msg",
+         measure(1, iterations, [&]() {
+           provider.callback(msgs[i++ % msgs.size()]);
+           return std::shared_ptr<void>();
+         }));
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  ros::Time::init();
+
+  /// optional factor scaling the amount of iterations
+  const std::size_t scale =
+      argc > 1 ? static_cast<std::size_t>(std::max(1, std::atoi(argv[1])))
+               : 1ul;
+  const std::size_t laser_iterations = 200 * scale;
+  const std::size_t cloud_iterations = 20 * scale;
+  const std::size_t odometry_iterations = 10000 * scale;
+
+  cslibs_plugins_data::common::WorkerPool workers{
+      std::max(1u, std::thread::hardware_concurrency()) - 1};
+
+  for (const std::size_t beams : {720ul, 1081ul, 2880ul}) {
+    benchmarkLaser<double>("double", beams, laser_iterations);
+    benchmarkLaser<float>("float", beams, laser_iterations);
+  }
+  for (cslibs_plugins_data::common::WorkerPool *pool :
+       {static_cast<cslibs_plugins_data::common::WorkerPool *>(nullptr),
+        &workers}) {
+    benchmarkCloud<double>("double", 16, 1024, cloud_iterations, pool);
+    benchmarkCloud<float>("float", 16, 1024, cloud_iterations, pool);
+    benchmarkCloud<double>("double", 64, 2048, cloud_iterations, pool);
+    benchmarkCloud<float>("float", 64, 2048, cloud_iterations, pool);
+  }
+  benchmarkOdometry<double>("double", odometry_iterations);
+  benchmarkOdometry<float>("float", odometry_iterations);
+  return 0;
+}
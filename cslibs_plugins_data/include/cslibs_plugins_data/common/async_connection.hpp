@@ -0,0 +1,220 @@
+#ifndef CSLIBS_PLUGINS_DATA_ASYNC_CONNECTION_HPP
+#define CSLIBS_PLUGINS_DATA_ASYNC_CONNECTION_HPP
+
+#include <cslibs_plugins_data/common/bounded_queue.hpp>
+#include <cslibs_plugins_data/data.hpp>
+#include <cslibs_utility/common/delegate.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Decouples a consumer from the thread data is provided on. Data is
+ *        pushed into a bounded queue which is drained by a dedicated worker
+ *        calling the consumer's callback.
+ */
+class AsyncConnection {
+ public:
+  using Ptr = std::shared_ptr<AsyncConnection>;
+  using callback_t =
+      cslibs_utility::common::delegate<void(const Data::ConstPtr &)>;
+
+  /**
+   * @brief Behaviour if the consumer cannot keep up.
+   *        DROP_OLDEST evicts the oldest queued data,
+   *        KEEP_LATEST only ever keeps the most recent data queued,
+   *        BLOCK makes the providing thread wait for free space.
+   */
+  enum class OverflowPolicy { DROP_OLDEST, KEEP_LATEST, BLOCK };
+
+  struct Options {
+    std::size_t queue_size = 8;
+    OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+  };
+
+  /**
+   * @brief Create a connection and start its worker.
+   * @param callback  the consumer callback
+   * @param options   queue size and overflow policy
+   * @param init      run by the worker before any callback, e.g. to set its
+   *                  affinity and priority
+   */
+  inline AsyncConnection(const callback_t &callback, const Options &options,
+                         const std::function<void()> &init = {})
+      : callback_{callback},
+        policy_{options.policy},
+        queue_{options.queue_size},
+        received_{0},
+        delivered_{0},
+        dropped_{0},
+        consumer_waiting_{false},
+        producer_waiting_{false},
+        stop_{false} {
+    worker_ = std::thread([this, init]() {
+      if (init) {
+        init();
+      }
+      loop();
+    });
+  }
+
+  inline ~AsyncConnection() { stop(); }
+
+  AsyncConnection(const AsyncConnection &other) = delete;
+  AsyncConnection &operator=(const AsyncConnection &other) = delete;
+
+  /**
+   * @brief Keep the connection to the data source alive as long as this
+   *        object lives, it is released before the worker stops.
+   */
+  inline void attach(const std::shared_ptr<void> &source_connection) {
+    source_connection_ = source_connection;
+  }
+
+  /**
+   * @brief Disconnect from the source and stop the worker, queued data is
+   *        discarded.
+   */
+  inline void stop() {
+    source_connection_.reset();
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (stop_) {
+        return;
+      }
+      stop_ = true;
+    }
+    data_available_.notify_all();
+    space_available_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  /**
+   * @brief Enqueue data, called on the providing thread.
+   */
+  inline void push(const Data::ConstPtr &data) {
+    ++received_;
+    switch (policy_) {
+      case OverflowPolicy::KEEP_LATEST:
+        discard(queue_.size());
+        pushOrDrop(data);
+        break;
+      case OverflowPolicy::DROP_OLDEST:
+        pushOrDrop(data);
+        break;
+      case OverflowPolicy::BLOCK:
+        while (!queue_.push(data)) {
+          std::unique_lock<std::mutex> l{mutex_};
+          if (stop_) {
+            return;
+          }
+          producer_waiting_ = true;
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          space_available_.wait(
+              l, [this]() { return stop_ || queue_.size() < queue_.capacity(); });
+          producer_waiting_ = false;
+        }
+        break;
+    }
+    wakeConsumer();
+  }
+
+  /**
+   * @brief Amount of data currently queued.
+   */
+  inline std::size_t depth() const { return queue_.size(); }
+
+  inline std::size_t capacity() const { return queue_.capacity(); }
+
+  /**
+   * @brief Amount of data handed to the connection.
+   */
+  inline std::size_t received() const { return received_; }
+
+  /**
+   * @brief Amount of data handed to the consumer.
+   */
+  inline std::size_t delivered() const { return delivered_; }
+
+  /**
+   * @brief Amount of data discarded due to overflow.
+   */
+  inline std::size_t dropped() const { return dropped_; }
+
+ private:
+  callback_t callback_;
+  const OverflowPolicy policy_;
+  BoundedQueue<Data::ConstPtr> queue_;
+  std::shared_ptr<void> source_connection_;
+
+  std::atomic<std::size_t> received_;
+  std::atomic<std::size_t> delivered_;
+  std::atomic<std::size_t> dropped_;
+
+  std::mutex mutex_;
+  std::condition_variable data_available_;
+  std::condition_variable space_available_;
+  std::atomic_bool consumer_waiting_;
+  std::atomic_bool producer_waiting_;
+  bool stop_;
+  std::thread worker_;
+
+  inline void pushOrDrop(const Data::ConstPtr &data) {
+    while (!queue_.push(data)) {
+      discard(1);
+    }
+  }
+
+  inline void discard(const std::size_t n) {
+    Data::ConstPtr d;
+    for (std::size_t i = 0; i < n && queue_.pop(d); ++i) {
+      ++dropped_;
+    }
+  }
+
+  inline void wakeConsumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting_) {
+      std::unique_lock<std::mutex> l{mutex_};
+      data_available_.notify_one();
+    }
+  }
+
+  inline void loop() {
+    Data::ConstPtr data;
+    while (true) {
+      if (queue_.pop(data)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producer_waiting_) {
+          std::unique_lock<std::mutex> l{mutex_};
+          space_available_.notify_one();
+        }
+        callback_(data);
+        data.reset();
+        ++delivered_;
+        continue;
+      }
+
+      std::unique_lock<std::mutex> l{mutex_};
+      consumer_waiting_ = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      data_available_.wait(l, [this]() { return stop_ || !queue_.empty(); });
+      consumer_waiting_ = false;
+      if (stop_) {
+        return;
+      }
+    }
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_ASYNC_CONNECTION_HPP
@@ -0,0 +1,131 @@
+#ifndef CSLIBS_PLUGINS_DATA_BOUNDED_QUEUE_HPP
+#define CSLIBS_PLUGINS_DATA_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Bounded lock-free ring buffer based on per slot sequence numbers.
+ *        Any thread may push or pop, which allows producers to evict old
+ *        entries while a consumer is draining the queue.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Create a queue, the capacity is rounded up to the next power of 2.
+   * @param capacity  the minimum amount of entries the queue can hold
+   */
+  inline explicit BoundedQueue(const std::size_t capacity)
+      : buffer_(roundUp(capacity)),
+        mask_{buffer_.size() - 1},
+        enqueue_pos_{0},
+        dequeue_pos_{0} {
+    for (std::size_t i = 0; i < buffer_.size(); ++i) {
+      buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue &other) = delete;
+  BoundedQueue &operator=(const BoundedQueue &other) = delete;
+
+  /**
+   * @brief Try to append an entry.
+   * @return false if the queue is full
+   */
+  inline bool push(const T &value) {
+    Cell *cell;
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & mask_];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t dif =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (dif == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Try to take the oldest entry.
+   * @return false if the queue is empty
+   */
+  inline bool pop(T &value) {
+    Cell *cell;
+    std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & mask_];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t dif =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (dif == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->data);
+    cell->data = T();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Approximate amount of queued entries.
+   */
+  inline std::size_t size() const {
+    const std::size_t e = enqueue_pos_.load(std::memory_order_acquire);
+    const std::size_t d = dequeue_pos_.load(std::memory_order_acquire);
+    return e > d ? e - d : 0ul;
+  }
+
+  inline bool empty() const { return size() == 0ul; }
+
+  inline std::size_t capacity() const { return buffer_.size(); }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T data;
+  };
+
+  std::vector<Cell> buffer_;
+  const std::size_t mask_;
+  /// keep producer and consumer positions on separate cache lines, padding
+  /// instead of alignas avoids over-aligned allocations prior to C++17
+  char pad_enqueue_[64];
+  std::atomic<std::size_t> enqueue_pos_;
+  char pad_dequeue_[64 - sizeof(std::atomic<std::size_t>)];
+  std::atomic<std::size_t> dequeue_pos_;
+
+  inline static std::size_t roundUp(const std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_BOUNDED_QUEUE_HPP
@@ -0,0 +1,206 @@
+#ifndef CSLIBS_PLUGINS_DATA_DEFERRED_TRANSFORM_QUEUE_HPP
+#define CSLIBS_PLUGINS_DATA_DEFERRED_TRANSFORM_QUEUE_HPP
+
+#include <ros/callback_queue_interface.h>
+
+#include <boost/make_shared.hpp>
+#include <cslibs_plugins_data/common/executor.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Bounded queue of messages whose transforms are not available yet.
+ *        Conversions are attempted without waiting for tf, failed attempts
+ *        are retried until they succeed or time out, so that the subscriber
+ *        callback never blocks. An executor only triggers the retries, they
+ *        run on the callback queue of the subscriber, so that converted data
+ *        is emitted from the same threads in either case. Messages are
+ *        converted in the order they were received.
+ */
+template <typename M>
+class DeferredTransformQueue {
+ public:
+  /// try to convert a message without waiting, false if tf is not ready
+  using attempt_t = std::function<bool(const M &)>;
+  /// called for messages which are evicted or timed out
+  using drop_t = std::function<void(const M &)>;
+  using clock_t = Executor::clock_t;
+
+  inline ~DeferredTransformQueue() { shutdown(); }
+
+  /**
+   * @brief Set up the queue and start retrying.
+   * @param executor      the executor triggering the retries
+   * @param queue         the callback queue to retry on, has to outlive
+   *                      the deferred queue or its shutdown
+   * @param capacity      the maximum amount of pending messages, the oldest
+   *                      one is dropped if exceeded
+   * @param timeout       the time after which pending messages are dropped
+   * @param retry_period  the period of retries
+   * @param attempt       the conversion
+   * @param drop          the handler for dropped messages
+   */
+  inline void setup(const Executor::Ptr &executor,
+                    ros::CallbackQueueInterface *queue,
+                    const std::size_t capacity,
+                    const Executor::duration_t &timeout,
+                    const Executor::duration_t &retry_period,
+                    const attempt_t &attempt, const drop_t &drop) {
+    capacity_ = std::max<std::size_t>(capacity, 1);
+    timeout_ = timeout;
+    attempt_ = attempt;
+    drop_ = drop;
+    queue_ = queue;
+    executor_ = executor;
+    task_ = executor_->scheduleEvery([this]() { post(); }, retry_period);
+  }
+
+  /**
+   * @brief Stop retrying, pending messages are discarded. Waits for a
+   *        running retry, thus must not be called from within one.
+   */
+  inline void shutdown() {
+    if (task_) {
+      task_->cancel();
+    }
+    if (queue_) {
+      queue_->removeByID(ownerId());
+    }
+    std::unique_lock<std::mutex> l{mutex_};
+    pending_.clear();
+    posted_ = false;
+  }
+
+  /**
+   * @brief Convert a message right away if nothing is pending, otherwise
+   *        or if its transform is not ready, park it for later.
+   */
+  inline void push(const M &msg) {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (!pending_.empty() || retrying_) {
+        enqueue(msg, l);
+        return;
+      }
+    }
+    if (attempt_(msg)) {
+      return;
+    }
+    std::unique_lock<std::mutex> l{mutex_};
+    enqueue(msg, l);
+  }
+
+  /**
+   * @brief Amount of messages waiting for their transforms.
+   */
+  inline std::size_t size() const {
+    std::unique_lock<std::mutex> l{mutex_};
+    return pending_.size();
+  }
+
+ private:
+  struct Pending {
+    M msg;
+    clock_t::time_point deadline;
+  };
+
+  class RetryCallback : public ros::CallbackInterface {
+   public:
+    inline explicit RetryCallback(DeferredTransformQueue *queue)
+        : queue_{queue} {}
+
+    inline CallResult call() override {
+      queue_->retry();
+      return Success;
+    }
+
+   private:
+    DeferredTransformQueue *queue_;
+  };
+
+  std::size_t capacity_ = 1;
+  Executor::duration_t timeout_;
+  attempt_t attempt_;
+  drop_t drop_;
+  ros::CallbackQueueInterface *queue_ = nullptr;
+  Executor::Ptr executor_;
+  Executor::Task::Ptr task_;
+
+  mutable std::mutex mutex_;
+  std::deque<Pending> pending_;
+  bool retrying_ = false;  /// head of the queue is being converted
+  bool posted_ = false;    /// a retry is waiting in the callback queue
+
+  inline uint64_t ownerId() const { return reinterpret_cast<uint64_t>(this); }
+
+  inline void post() {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (pending_.empty() || posted_) {
+        return;
+      }
+      posted_ = true;
+    }
+    queue_->addCallback(boost::make_shared<RetryCallback>(this), ownerId());
+  }
+
+  inline void enqueue(const M &msg, std::unique_lock<std::mutex> &l) {
+    pending_.emplace_back(Pending{msg, clock_t::now() + timeout_});
+    if (pending_.size() <= capacity_) {
+      return;
+    }
+    const M evicted = pending_.front().msg;
+    pending_.pop_front();
+    l.unlock();
+    drop_(evicted);
+  }
+
+  void retry() {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      posted_ = false;
+    }
+    while (true) {
+      Pending p;
+      {
+        std::unique_lock<std::mutex> l{mutex_};
+        if (pending_.empty()) {
+          return;
+        }
+        p = pending_.front();
+        pending_.pop_front();
+        retrying_ = true;
+      }
+
+      const bool converted = attempt_(p.msg);
+      const bool expired = !converted && clock_t::now() >= p.deadline;
+      {
+        std::unique_lock<std::mutex> l{mutex_};
+        retrying_ = false;
+        if (!converted && !expired) {
+          /// later messages will not find their transforms either
+          pending_.emplace_front(p);
+          if (pending_.size() > capacity_) {
+            p = pending_.front();
+            pending_.pop_front();
+            l.unlock();
+            drop_(p.msg);
+          }
+          return;
+        }
+      }
+      if (expired) {
+        drop_(p.msg);
+      }
+    }
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_DEFERRED_TRANSFORM_QUEUE_HPP
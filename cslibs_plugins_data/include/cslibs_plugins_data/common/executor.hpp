@@ -0,0 +1,269 @@
+#ifndef CSLIBS_PLUGINS_DATA_EXECUTOR_HPP
+#define CSLIBS_PLUGINS_DATA_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Small pool of threads running delayed and periodic tasks ordered by
+ *        their due time. Providers share one process wide instance for their
+ *        background work instead of keeping mostly sleeping threads each.
+ */
+class Executor {
+ public:
+  using Ptr = std::shared_ptr<Executor>;
+  using clock_t = std::chrono::steady_clock;
+  using time_point_t = clock_t::time_point;
+  using duration_t = clock_t::duration;
+  /// run once, set the next due time and return true to be run again
+  using repeat_t = std::function<bool(time_point_t &)>;
+
+  /**
+   * @brief Handle of a scheduled task.
+   */
+  class Task {
+   public:
+    using Ptr = std::shared_ptr<Task>;
+
+    /**
+     * @brief Prevent further runs and block until a running one is finished,
+     *        unless called from within the task itself.
+     */
+    inline void cancel() {
+      cancelled_ = true;
+      if (runner_.load() == std::this_thread::get_id()) {
+        return;
+      }
+      std::unique_lock<std::mutex> l{run_mutex_};
+    }
+
+    inline bool cancelled() const { return cancelled_; }
+
+   private:
+    friend class Executor;
+
+    inline explicit Task(const repeat_t &fn) : fn_{fn}, cancelled_{false} {}
+
+    const repeat_t fn_;
+    std::atomic_bool cancelled_;
+    std::atomic<std::thread::id> runner_;
+    std::mutex run_mutex_;
+  };
+
+  /**
+   * @brief Create an executor with a given number of threads.
+   * @param threads   the amount of worker threads, at least one
+   * @param init      run by each thread before any task, e.g. to set its
+   *                  affinity and priority
+   */
+  inline explicit Executor(const std::size_t threads,
+                           const std::function<void()> &init = {})
+      : stop_{false} {
+    for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+      threads_.emplace_back([this, init]() {
+        if (init) {
+          init();
+        }
+        loop();
+      });
+    }
+  }
+
+  /**
+   * @brief The process wide executor, created on first use.
+   */
+  inline static Ptr shared() {
+    std::unique_lock<std::mutex> l{sharedMutex()};
+    Ptr &executor = sharedInstance();
+    if (!executor) {
+      executor.reset(new Executor(sharedThreads()));
+    }
+    return executor;
+  }
+
+  /**
+   * @brief Set the size of the process wide executor.
+   * @param threads   the amount of worker threads
+   * @return false if it is already running with a different size
+   */
+  inline static bool configure(const std::size_t threads) {
+    std::unique_lock<std::mutex> l{sharedMutex()};
+    const Ptr &executor = sharedInstance();
+    if (executor) {
+      return executor->size() == std::max<std::size_t>(threads, 1);
+    }
+    sharedThreads() = threads;
+    return true;
+  }
+
+  /**
+   * @brief Stops and joins all threads, pending tasks are discarded.
+   */
+  inline ~Executor() { shutdown(); }
+
+  Executor(const Executor &other) = delete;
+  Executor &operator=(const Executor &other) = delete;
+
+  inline std::size_t size() const { return threads_.size(); }
+
+  /**
+   * @brief Run a task once after a delay.
+   */
+  inline Task::Ptr schedule(const std::function<void()> &fn,
+                            const duration_t &delay = duration_t::zero()) {
+    return scheduleRepeated(
+        [fn](time_point_t &) {
+          fn();
+          return false;
+        },
+        clock_t::now() + delay);
+  }
+
+  /**
+   * @brief Run a task periodically, the first time after one period. Runs
+   *        which are late do not accumulate but shift the following ones.
+   */
+  inline Task::Ptr scheduleEvery(const std::function<void()> &fn,
+                                 const duration_t &period) {
+    return scheduleRepeated(
+        [fn, period](time_point_t &next) {
+          fn();
+          next = std::max(next + period, clock_t::now());
+          return true;
+        },
+        clock_t::now() + period);
+  }
+
+  /**
+   * @brief Run a task which decides about its next due time itself.
+   * @param fn      the task, called with its current due time
+   * @param first   the first due time
+   */
+  inline Task::Ptr scheduleRepeated(const repeat_t &fn,
+                                    const time_point_t &first) {
+    Task::Ptr task{new Task(fn)};
+    enqueue(first, task);
+    return task;
+  }
+
+  /**
+   * @brief Stop and join all threads, must not be called from a task.
+   */
+  inline void shutdown() {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      stop_ = true;
+    }
+    notify_.notify_all();
+    for (auto &t : threads_) {
+      if (t.joinable()) {
+        t.join();
+      }
+    }
+    std::unique_lock<std::mutex> l{mutex_};
+    queue_ = queue_t();
+  }
+
+ private:
+  struct Entry {
+    time_point_t due;
+    uint64_t sequence;  /// keeps tasks due at the same time in order
+    Task::Ptr task;
+
+    inline bool operator>(const Entry &other) const {
+      return due == other.due ? sequence > other.sequence : due > other.due;
+    }
+  };
+  using queue_t =
+      std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable notify_;
+  queue_t queue_;
+  uint64_t sequence_ = 0;
+  bool stop_;
+
+  inline static std::mutex &sharedMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  inline static Ptr &sharedInstance() {
+    static Ptr executor;
+    return executor;
+  }
+
+  inline static std::size_t &sharedThreads() {
+    static std::size_t threads = 2;
+    return threads;
+  }
+
+  inline void enqueue(const time_point_t &due, const Task::Ptr &task) {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (stop_) {
+        return;
+      }
+      queue_.emplace(Entry{due, sequence_++, task});
+    }
+    notify_.notify_one();
+  }
+
+  inline void loop() {
+    while (true) {
+      Entry entry;
+      {
+        std::unique_lock<std::mutex> l{mutex_};
+        while (!stop_) {
+          if (queue_.empty()) {
+            notify_.wait(l);
+          } else if (queue_.top().due > clock_t::now()) {
+            notify_.wait_until(l, queue_.top().due);
+          } else {
+            break;
+          }
+        }
+        if (stop_) {
+          return;
+        }
+        entry = queue_.top();
+        queue_.pop();
+      }
+
+      Task &task = *entry.task;
+      bool again = false;
+      {
+        std::unique_lock<std::mutex> l{task.run_mutex_};
+        if (task.cancelled_) {
+          continue;
+        }
+        task.runner_ = std::this_thread::get_id();
+        try {
+          again = task.fn_(entry.due);
+        } catch (...) {
+          /// a throwing task is not run again
+          again = false;
+        }
+        task.runner_ = std::thread::id();
+      }
+      if (again && !task.cancelled_) {
+        enqueue(entry.due, entry.task);
+      }
+    }
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_EXECUTOR_HPP
@@ -0,0 +1,28 @@
+#ifndef CSLIBS_PLUGINS_DATA_FINITE_HPP
+#define CSLIBS_PLUGINS_DATA_FINITE_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Test if a value is neither NaN nor infinite by its exponent bits.
+ *        Unlike std::isfinite this is not folded to true when compiling with
+ *        -ffast-math, which assumes that no such values exist.
+ */
+inline bool isFinite(const float v) {
+  uint32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return (bits & 0x7f800000u) != 0x7f800000u;
+}
+
+inline bool isFinite(const double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return (bits & 0x7ff0000000000000ull) != 0x7ff0000000000000ull;
+}
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_FINITE_HPP
@@ -0,0 +1,95 @@
+#ifndef CSLIBS_PLUGINS_DATA_FRAME_ID_HPP
+#define CSLIBS_PLUGINS_DATA_FRAME_ID_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Frame name interned into a process wide table. Copies and
+ *        comparisons are pointer operations, the name stays valid for the
+ *        lifetime of the process. Constructing from a name looks it up in a
+ *        thread local cache first, so only new names take the table lock.
+ */
+class FrameId {
+ public:
+  /**
+   * @brief The empty frame.
+   */
+  inline FrameId() : entry_{intern(std::string())} {}
+
+  inline FrameId(const std::string &name) : entry_{intern(name)} {}
+
+  inline FrameId(const char *name) : entry_{intern(std::string(name))} {}
+
+  inline std::string const &name() const { return entry_->name; }
+
+  /**
+   * @brief Dense index in order of interning, e.g. to index lookup tables.
+   */
+  inline uint32_t index() const { return entry_->index; }
+
+  inline bool operator==(const FrameId &other) const {
+    return entry_ == other.entry_;
+  }
+
+  inline bool operator!=(const FrameId &other) const {
+    return entry_ != other.entry_;
+  }
+
+  inline bool operator<(const FrameId &other) const {
+    return entry_->index < other.entry_->index;
+  }
+
+ private:
+  struct Entry {
+    std::string name;
+    uint32_t index;
+  };
+  using table_t = std::unordered_map<std::string, std::unique_ptr<Entry>>;
+  using cache_t = std::unordered_map<std::string, const Entry *>;
+
+  const Entry *entry_;
+
+  inline static const Entry *intern(const std::string &name) {
+    thread_local cache_t cache;
+    const auto cached = cache.find(name);
+    if (cached != cache.end()) {
+      return cached->second;
+    }
+
+    static std::mutex mutex;
+    static table_t table;
+    const Entry *entry;
+    {
+      std::unique_lock<std::mutex> l{mutex};
+      auto &slot = table[name];
+      if (!slot) {
+        slot.reset(
+            new Entry{name, static_cast<uint32_t>(table.size() - 1)});
+      }
+      entry = slot.get();
+    }
+    cache.emplace(name, entry);
+    return entry;
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+namespace std {
+template <>
+struct hash<cslibs_plugins_data::common::FrameId> {
+  inline std::size_t operator()(
+      const cslibs_plugins_data::common::FrameId &id) const {
+    return id.index();
+  }
+};
+}  // namespace std
+
+#endif  // CSLIBS_PLUGINS_DATA_FRAME_ID_HPP
@@ -0,0 +1,193 @@
+#ifndef CSLIBS_PLUGINS_DATA_PROVIDER_STATS_HPP
+#define CSLIBS_PLUGINS_DATA_PROVIDER_STATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Lock-free latency histogram with power of 2 buckets in ns. Bucket i
+ *        counts durations in [2^(i-1), 2^i), recording is a handful of relaxed
+ *        atomic increments.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr std::size_t BUCKETS = 40;  /// up to ~9 minutes
+
+  struct Snapshot {
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, BUCKETS> buckets{};
+
+    inline double mean() const {
+      return count > 0 ? static_cast<double>(sum_ns) / count : 0.0;
+    }
+
+    /**
+     * @brief Upper bound of the bucket containing the given quantile.
+     * @param q   quantile in [0, 1]
+     */
+    inline uint64_t quantile(const double q) const {
+      const uint64_t rank = static_cast<uint64_t>(q * count);
+      uint64_t seen = 0;
+      for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+          return std::min<uint64_t>(1ull << i, max_ns);
+        }
+      }
+      return max_ns;
+    }
+  };
+
+  inline LatencyHistogram() { reset(); }
+
+  LatencyHistogram(const LatencyHistogram &other) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+  /**
+   * @brief Record a duration, negative durations e.g. due to clock skew are
+   *        counted as zero.
+   */
+  inline void record(const int64_t ns) {
+    const uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0ull;
+    buckets_[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(v, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (v > max &&
+           !max_.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+    }
+  }
+
+  template <typename Rep, typename Period>
+  inline void record(const std::chrono::duration<Rep, Period> &d) {
+    record(static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+  }
+
+  /**
+   * @brief Consistent per value, but not across values while recording.
+   */
+  inline Snapshot snapshot() const {
+    Snapshot s;
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum_ns = sum_.load(std::memory_order_relaxed);
+    s.max_ns = max_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+      s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return s;
+  }
+
+  inline void reset() {
+    for (auto &b : buckets_) {
+      b.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+
+  inline static std::size_t bucket(const uint64_t v) {
+    const std::size_t b =
+        v == 0 ? 0ul : 64ul - static_cast<std::size_t>(__builtin_clzll(v));
+    return b < BUCKETS ? b : BUCKETS - 1;
+  }
+};
+
+/**
+ * @brief Latency histograms and counters of a data provider.
+ *        transport   - header stamp to callback entry
+ *        tf_wait     - time spent waiting for transforms
+ *        conversion  - message to data conversion, tf waits excluded
+ *        dispatch    - time spent in the consumers' callbacks
+ *        jitter      - lateness of scheduled work behind its due time
+ */
+class ProviderStats {
+ public:
+  using clock_t = std::chrono::steady_clock;
+
+  struct Snapshot {
+    uint64_t received = 0;
+    uint64_t throttled = 0;
+    uint64_t failed_tf = 0;
+    uint64_t emitted = 0;
+    LatencyHistogram::Snapshot transport;
+    LatencyHistogram::Snapshot tf_wait;
+    LatencyHistogram::Snapshot conversion;
+    LatencyHistogram::Snapshot dispatch;
+    LatencyHistogram::Snapshot jitter;
+  };
+
+  /**
+   * @brief Records the time elapsed from construction to destruction.
+   */
+  class ScopedTimer {
+   public:
+    inline explicit ScopedTimer(LatencyHistogram &histogram)
+        : histogram_(histogram), start_(clock_t::now()) {}
+    inline ~ScopedTimer() { histogram_.record(clock_t::now() - start_); }
+
+   private:
+    LatencyHistogram &histogram_;
+    const clock_t::time_point start_;
+  };
+
+  inline ProviderStats() { reset(); }
+
+  ProviderStats(const ProviderStats &other) = delete;
+  ProviderStats &operator=(const ProviderStats &other) = delete;
+
+  LatencyHistogram transport;
+  LatencyHistogram tf_wait;
+  LatencyHistogram conversion;
+  LatencyHistogram dispatch;
+  LatencyHistogram jitter;
+
+  std::atomic<uint64_t> received;
+  std::atomic<uint64_t> throttled;
+  std::atomic<uint64_t> failed_tf;
+  std::atomic<uint64_t> emitted;
+
+  inline Snapshot snapshot() const {
+    Snapshot s;
+    s.received = received.load(std::memory_order_relaxed);
+    s.throttled = throttled.load(std::memory_order_relaxed);
+    s.failed_tf = failed_tf.load(std::memory_order_relaxed);
+    s.emitted = emitted.load(std::memory_order_relaxed);
+    s.transport = transport.snapshot();
+    s.tf_wait = tf_wait.snapshot();
+    s.conversion = conversion.snapshot();
+    s.dispatch = dispatch.snapshot();
+    s.jitter = jitter.snapshot();
+    return s;
+  }
+
+  inline void reset() {
+    transport.reset();
+    tf_wait.reset();
+    conversion.reset();
+    dispatch.reset();
+    jitter.reset();
+    received.store(0, std::memory_order_relaxed);
+    throttled.store(0, std::memory_order_relaxed);
+    failed_tf.store(0, std::memory_order_relaxed);
+    emitted.store(0, std::memory_order_relaxed);
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_PROVIDER_STATS_HPP
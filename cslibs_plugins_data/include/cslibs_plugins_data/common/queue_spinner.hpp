@@ -0,0 +1,68 @@
+#ifndef CSLIBS_PLUGINS_DATA_QUEUE_SPINNER_HPP
+#define CSLIBS_PLUGINS_DATA_QUEUE_SPINNER_HPP
+
+#include <ros/callback_queue.h>
+#include <ros/init.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Serves a callback queue with own threads, which unlike the ones of
+ *        ros::AsyncSpinner can be set up before they handle any callback.
+ */
+class QueueSpinner {
+ public:
+  /**
+   * @brief Start serving the queue.
+   * @param queue     the callback queue, has to outlive the spinner
+   * @param threads   the amount of threads, at least one
+   * @param init      run by each thread before any callback, e.g. to set its
+   *                  affinity and priority
+   */
+  inline QueueSpinner(ros::CallbackQueue &queue, const std::size_t threads,
+                      const std::function<void()> &init = {})
+      : queue_(queue), running_{true} {
+    for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+      threads_.emplace_back([this, init]() {
+        if (init) {
+          init();
+        }
+        while (running_ && ros::ok()) {
+          queue_.callAvailable(ros::WallDuration(0.1));
+        }
+      });
+    }
+  }
+
+  inline ~QueueSpinner() { stop(); }
+
+  QueueSpinner(const QueueSpinner &other) = delete;
+  QueueSpinner &operator=(const QueueSpinner &other) = delete;
+
+  /**
+   * @brief Stop serving the queue and wait for running callbacks.
+   */
+  inline void stop() {
+    running_ = false;
+    for (auto &t : threads_) {
+      if (t.joinable()) {
+        t.join();
+      }
+    }
+  }
+
+ private:
+  ros::CallbackQueue &queue_;
+  std::atomic_bool running_;
+  std::vector<std::thread> threads_;
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_QUEUE_SPINNER_HPP
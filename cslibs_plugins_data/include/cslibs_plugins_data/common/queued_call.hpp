@@ -0,0 +1,44 @@
+#ifndef CSLIBS_PLUGINS_DATA_QUEUED_CALL_HPP
+#define CSLIBS_PLUGINS_DATA_QUEUED_CALL_HPP
+
+#include <ros/callback_queue_interface.h>
+
+#include <boost/make_shared.hpp>
+
+#include <functional>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief A function called once by the threads serving a callback queue, so
+ *        that work triggered on the executor is done where the provider's
+ *        subscription callbacks run instead of blocking executor threads.
+ */
+class QueuedCall : public ros::CallbackInterface {
+ public:
+  inline explicit QueuedCall(const std::function<void()> &fn) : fn_{fn} {}
+
+  inline CallResult call() override {
+    fn_();
+    return Success;
+  }
+
+  /**
+   * @brief Add a call to a queue.
+   * @param queue     the callback queue
+   * @param fn        the function to call
+   * @param owner_id  id to remove pending calls by, e.g. on shutdown
+   */
+  inline static void post(ros::CallbackQueueInterface *queue,
+                          const std::function<void()> &fn,
+                          const uint64_t owner_id) {
+    queue->addCallback(boost::make_shared<QueuedCall>(fn), owner_id);
+  }
+
+ private:
+  std::function<void()> fn_;
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_QUEUED_CALL_HPP
@@ -0,0 +1,227 @@
+#ifndef CSLIBS_PLUGINS_DATA_STATIC_TRANSFORM_CACHE_HPP
+#define CSLIBS_PLUGINS_DATA_STATIC_TRANSFORM_CACHE_HPP
+
+#include <ros/callback_queue.h>
+#include <ros/node_handle.h>
+#include <tf2_msgs/TFMessage.h>
+
+#include <cslibs_math_3d/linear/transform.hpp>
+#include <cslibs_math_ros/tf/tf_provider.hpp>
+#include <cslibs_plugins_data/common/frame_id.hpp>
+#include <cslibs_plugins_data/common/queue_spinner.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Tree of frames connected by transforms published on /tf_static. A
+ *        single instance with one subscription is shared by all users and
+ *        lives as long as any of them. The subscription is served by an own
+ *        queue and thread, independent of the queues of its users.
+ */
+class StaticFrameGraph {
+ public:
+  using Ptr = std::shared_ptr<StaticFrameGraph>;
+
+  /**
+   * @brief Get the shared graph, subscribing to /tf_static on first use.
+   */
+  inline static Ptr instance() {
+    static std::mutex mutex;
+    static std::weak_ptr<StaticFrameGraph> shared;
+
+    std::unique_lock<std::mutex> l{mutex};
+    Ptr graph = shared.lock();
+    if (!graph) {
+      graph.reset(new StaticFrameGraph);
+      ros::NodeHandle nh;
+      nh.setCallbackQueue(&graph->queue_);
+      graph->source_ = nh.subscribe("/tf_static", 100,
+                                    &StaticFrameGraph::callback, graph.get());
+      graph->spinner_.reset(new QueueSpinner(graph->queue_, 1));
+      shared = graph;
+    }
+    return graph;
+  }
+
+  inline ~StaticFrameGraph() {
+    source_.shutdown();
+    spinner_.reset();
+  }
+
+  /**
+   * @brief Incremented whenever a static transform is received, so that
+   *        cached transforms can be invalidated.
+   */
+  inline uint64_t generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Test if two frames are connected by static transforms only.
+   */
+  inline bool connected(const std::string &target,
+                        const std::string &source) const {
+    const std::string t = normalize(target);
+    const std::string s = normalize(source);
+    if (t == s) {
+      return true;
+    }
+
+    std::unique_lock<std::mutex> l{mutex_};
+    std::unordered_set<std::string> ancestors;
+    for (std::string f = s;;) {
+      ancestors.insert(f);
+      const auto parent = parents_.find(f);
+      if (parent == parents_.end() || ancestors.count(parent->second)) {
+        break;
+      }
+      f = parent->second;
+    }
+    std::unordered_set<std::string> visited;
+    for (std::string f = t; visited.insert(f).second;) {
+      if (ancestors.count(f)) {
+        return true;
+      }
+      const auto parent = parents_.find(f);
+      if (parent == parents_.end()) {
+        break;
+      }
+      f = parent->second;
+    }
+    return false;
+  }
+
+ private:
+  ros::CallbackQueue queue_;
+  std::unique_ptr<QueueSpinner> spinner_;
+  ros::Subscriber source_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::string> parents_;  /// child to parent
+  std::atomic<uint64_t> generation_{0};
+
+  StaticFrameGraph() = default;
+
+  inline static std::string normalize(const std::string &frame) {
+    return !frame.empty() && frame.front() == '/' ? frame.substr(1) : frame;
+  }
+
+  void callback(const tf2_msgs::TFMessageConstPtr &msg) {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      for (const auto &t : msg->transforms) {
+        parents_[normalize(t.child_frame_id)] = normalize(t.header.frame_id);
+      }
+    }
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+  }
+};
+
+/**
+ * @brief Looks up sensor to target transforms, consulting tf only once for
+ *        chains which are static. A chain is static if it is declared so or
+ *        if all of its transforms are published on /tf_static.
+ */
+template <typename T>
+class StaticTransformCache {
+ public:
+  using transform_t = cslibs_math_3d::Transform3<T>;
+  using tf_provider_t = cslibs_math_ros::tf::TFProvider;
+
+  /**
+   * @brief Set up the cache.
+   * @param assume_static   treat every chain as static
+   * @param detect_static   detect static chains from /tf_static
+   */
+  inline void setup(const bool assume_static, const bool detect_static) {
+    assume_static_ = assume_static;
+    if (detect_static && !assume_static) {
+      graph_ = StaticFrameGraph::instance();
+    }
+  }
+
+  /**
+   * @brief Look up the transform from source into target frame.
+   * @param tf        the tf provider used for non static or uncached chains
+   * @param target    the target frame
+   * @param source    the source frame
+   * @param stamp     the time of the transform, ignored for static chains
+   * @param t         the transform
+   * @param timeout   the maximum time to wait for the transform
+   * @return false if the transform could not be looked up
+   */
+  inline bool lookup(tf_provider_t &tf, const std::string &target,
+                     const std::string &source, const ros::Time &stamp,
+                     transform_t &t, const ros::Duration &timeout) {
+    if (!assume_static_ && !graph_) {
+      return tf.lookupTransform(target, source, stamp, t, timeout);
+    }
+
+    const key_t key{FrameId(target), FrameId(source)};
+    const uint64_t generation = graph_ ? graph_->generation() : 0ul;
+    bool is_static = assume_static_;
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (generation != generation_) {
+        /// static transforms changed, decide and look up again
+        entries_.clear();
+        generation_ = generation;
+      }
+      const auto entry = entries_.find(key);
+      if (entry != entries_.end()) {
+        if (!entry->second.is_static) {
+          l.unlock();
+          return tf.lookupTransform(target, source, stamp, t, timeout);
+        }
+        t = entry->second.transform;
+        return true;
+      }
+    }
+
+    if (!is_static) {
+      is_static = graph_->connected(target, source);
+    }
+    entry_t entry;
+    entry.is_static = is_static;
+    const bool found = tf.lookupTransform(
+        target, source, is_static ? ros::Time(0) : stamp, entry.transform,
+        timeout);
+    if (found || !is_static) {
+      std::unique_lock<std::mutex> l{mutex_};
+      if (generation == generation_) {
+        entries_.emplace(key, entry);
+      }
+    }
+    t = entry.transform;
+    return found;
+  }
+
+ private:
+  using key_t = std::pair<FrameId, FrameId>;
+  struct entry_t {
+    bool is_static = false;
+    transform_t transform;
+  };
+  using entries_t =
+      std::map<key_t, entry_t, std::less<key_t>,
+               Eigen::aligned_allocator<std::pair<const key_t, entry_t>>>;
+
+  bool assume_static_ = false;
+  StaticFrameGraph::Ptr graph_;
+
+  std::mutex mutex_;
+  entries_t entries_;
+  uint64_t generation_ = 0;
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_STATIC_TRANSFORM_CACHE_HPP
@@ -0,0 +1,84 @@
+#ifndef CSLIBS_PLUGINS_DATA_THREAD_SETTINGS_HPP
+#define CSLIBS_PLUGINS_DATA_THREAD_SETTINGS_HPP
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief CPU affinity and scheduling of a thread, applied by the thread
+ *        itself. Linux only, real time priorities require CAP_SYS_NICE or an
+ *        according rtprio limit.
+ */
+struct ThreadSettings {
+  std::vector<int> cpus;  /// allowed CPUs, empty for no restriction
+  int fifo_priority = 0;  /// SCHED_FIFO priority in [1, 99], 0 keeps the policy
+  int nice = 0;           /// nice value for non real time threads
+
+  /**
+   * @brief Test if applying would change anything.
+   */
+  inline bool empty() const {
+    return cpus.empty() && fifo_priority <= 0 && nice == 0;
+  }
+
+  /**
+   * @brief Apply to the calling thread. Everything possible is applied even
+   *        if a part fails.
+   * @param error   description of the failed parts
+   * @return false if anything failed
+   */
+  inline bool apply(std::string &error) const {
+    error.clear();
+    auto append = [&error](const std::string &what, const int e) {
+      if (!error.empty()) {
+        error += ", ";
+      }
+      error += "cannot set " + what + ": " + std::strerror(e);
+    };
+
+    if (!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (const int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+          CPU_SET(cpu, &set);
+        }
+      }
+      const int e = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      if (e != 0) {
+        append("cpu affinity", e);
+      }
+    }
+    if (fifo_priority > 0) {
+      sched_param param;
+      param.sched_priority = std::min(
+          fifo_priority, sched_get_priority_max(SCHED_FIFO));
+      const int e = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (e != 0) {
+        append("SCHED_FIFO priority", e);
+      }
+    } else if (nice != 0) {
+      /// on Linux the nice value is a property of the thread
+      const id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+      if (setpriority(PRIO_PROCESS, tid, nice) != 0) {
+        append("nice value", errno);
+      }
+    }
+    return error.empty();
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_THREAD_SETTINGS_HPP
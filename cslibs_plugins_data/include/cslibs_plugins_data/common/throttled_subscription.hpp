@@ -0,0 +1,162 @@
+#ifndef CSLIBS_PLUGINS_DATA_THROTTLED_SUBSCRIPTION_HPP
+#define CSLIBS_PLUGINS_DATA_THROTTLED_SUBSCRIPTION_HPP
+
+#include <ros/message_traits.h>
+#include <ros/node_handle.h>
+#include <ros/serialization.h>
+#include <ros/subscribe_options.h>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Lets through one message per period based on header stamps, safe to
+ *        be queried from multiple threads.
+ */
+class RateGate {
+ public:
+  using Ptr = std::shared_ptr<RateGate>;
+
+  inline explicit RateGate(const ros::Duration &period)
+      : period_{static_cast<uint64_t>(period.toNSec())}, last_{0} {}
+
+  /**
+   * @brief Test if a message passes, passing messages close the gate for the
+   *        next period.
+   * @param stamp   the header stamp of the message
+   */
+  inline bool pass(const ros::Time &stamp) {
+    const uint64_t s = stamp.toNSec();
+    uint64_t last = last_.load(std::memory_order_relaxed);
+    do {
+      if (last != 0 && s <= last + period_) {
+        return false;
+      }
+    } while (!last_.compare_exchange_weak(last, s, std::memory_order_relaxed));
+    return true;
+  }
+
+ private:
+  const uint64_t period_;
+  std::atomic<uint64_t> last_;
+};
+
+/**
+ * @brief Subscription type for messages starting with a std_msgs/Header,
+ *        which only deserializes messages passing a rate gate. The header
+ *        stamp is read directly from the serialized buffer, for throttled
+ *        messages msg stays empty.
+ */
+template <typename M>
+struct ThrottledMessage {
+  using Ptr = boost::shared_ptr<ThrottledMessage<M>>;
+  using ConstPtr = boost::shared_ptr<const ThrottledMessage<M>>;
+
+  RateGate::Ptr gate;
+  ros::Time stamp;
+  boost::shared_ptr<M> msg;
+};
+
+/**
+ * @brief Subscribe to a topic, only messages passing the gate are
+ *        deserialized and handed to the callback in full.
+ * @param nh          node handle, determines the callback queue
+ * @param topic       the topic to subscribe to
+ * @param queue_size  the subscription queue size
+ * @param gate        the rate gate
+ * @param callback    called for every message, msg is empty if throttled
+ */
+template <typename M>
+inline ros::Subscriber subscribeThrottled(
+    ros::NodeHandle &nh, const std::string &topic, const uint32_t queue_size,
+    const RateGate::Ptr &gate,
+    const boost::function<void(const typename ThrottledMessage<M>::ConstPtr &)>
+        &callback) {
+  ros::SubscribeOptions options;
+  options.init<ThrottledMessage<M>>(
+      topic, queue_size, callback, [gate]() {
+        typename ThrottledMessage<M>::Ptr m{new ThrottledMessage<M>};
+        m->gate = gate;
+        return m;
+      });
+  return nh.subscribe(options);
+}
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+namespace ros {
+namespace message_traits {
+template <typename M>
+struct MD5Sum<cslibs_plugins_data::common::ThrottledMessage<M>> {
+  static const char *value() { return MD5Sum<M>::value(); }
+  static const char *value(const cslibs_plugins_data::common::ThrottledMessage<M> &) {
+    return value();
+  }
+};
+
+template <typename M>
+struct DataType<cslibs_plugins_data::common::ThrottledMessage<M>> {
+  static const char *value() { return DataType<M>::value(); }
+  static const char *value(const cslibs_plugins_data::common::ThrottledMessage<M> &) {
+    return value();
+  }
+};
+
+template <typename M>
+struct Definition<cslibs_plugins_data::common::ThrottledMessage<M>> {
+  static const char *value() { return Definition<M>::value(); }
+  static const char *value(const cslibs_plugins_data::common::ThrottledMessage<M> &) {
+    return value();
+  }
+};
+}  // namespace message_traits
+
+namespace serialization {
+template <typename M>
+struct Serializer<cslibs_plugins_data::common::ThrottledMessage<M>> {
+  static_assert(message_traits::HasHeader<M>::value,
+                "Throttling requires messages starting with a header.");
+
+  template <typename Stream>
+  inline static void write(Stream &stream,
+                           const cslibs_plugins_data::common::ThrottledMessage<M> &m) {
+    if (m.msg) {
+      serialize(stream, *m.msg);
+    }
+  }
+
+  template <typename Stream>
+  inline static void read(Stream &stream,
+                          cslibs_plugins_data::common::ThrottledMessage<M> &m) {
+    /// std_msgs/Header: uint32 seq, uint32 sec, uint32 nsec, string frame_id
+    if (stream.getLength() >= 3 * sizeof(uint32_t)) {
+      uint32_t sec;
+      uint32_t nsec;
+      std::memcpy(&sec, stream.getData() + sizeof(uint32_t), sizeof(uint32_t));
+      std::memcpy(&nsec, stream.getData() + 2 * sizeof(uint32_t),
+                  sizeof(uint32_t));
+      m.stamp = ros::Time(sec, nsec);
+    }
+    if (m.gate && !m.gate->pass(m.stamp)) {
+      return;
+    }
+    m.msg.reset(new M);
+    deserialize(stream, *m.msg);
+  }
+
+  inline static uint32_t serializedLength(
+      const cslibs_plugins_data::common::ThrottledMessage<M> &m) {
+    return m.msg ? serializationLength(*m.msg) : 0u;
+  }
+};
+}  // namespace serialization
+}  // namespace ros
+
+#endif  // CSLIBS_PLUGINS_DATA_THROTTLED_SUBSCRIPTION_HPP
@@ -0,0 +1,201 @@
+#ifndef CSLIBS_PLUGINS_DATA_WORKER_POOL_HPP
+#define CSLIBS_PLUGINS_DATA_WORKER_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace common {
+/**
+ * @brief Small fork-join thread pool for data parallel work inside providers.
+ *        The calling thread always takes part in the work, so a pool without
+ *        workers simply executes everything inline.
+ */
+class WorkerPool {
+ public:
+  using Ptr = std::shared_ptr<WorkerPool>;
+
+  /**
+   * @brief Create a pool with a given number of background workers.
+   * @param workers   the amount of worker threads
+   * @param init      run by each worker before any work, e.g. to set its
+   *                  affinity and priority
+   */
+  inline explicit WorkerPool(const std::size_t workers,
+                             const std::function<void()> &init = {})
+      : stop_{false} {
+    for (std::size_t i = 0; i < workers; ++i) {
+      threads_.emplace_back([this, init]() {
+        if (init) {
+          init();
+        }
+        loop();
+      });
+    }
+  }
+
+  /**
+   * @brief The process wide pool with one worker less than hardware threads,
+   *        shared by all providers so that they do not oversubscribe the CPU.
+   */
+  inline static Ptr shared() {
+    static const Ptr pool{new WorkerPool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1u)};
+    return pool;
+  }
+
+  /**
+   * @brief Create a handle onto another pool which lets at most max_threads
+   *        threads, including the calling one, work on each batch.
+   * @param pool        the pool doing the work
+   * @param max_threads upper bound of threads per batch
+   */
+  inline static Ptr limit(const Ptr &pool, const std::size_t max_threads) {
+    Ptr handle{new WorkerPool(0)};
+    handle->parent_ = pool;
+    handle->limit_ = std::max<std::size_t>(max_threads, 1) - 1;
+    return handle;
+  }
+
+  inline ~WorkerPool() {
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      stop_ = true;
+    }
+    notify_.notify_all();
+    for (auto &t : threads_) {
+      if (t.joinable()) {
+        t.join();
+      }
+    }
+  }
+
+  WorkerPool(const WorkerPool &other) = delete;
+  WorkerPool &operator=(const WorkerPool &other) = delete;
+
+  /**
+   * @brief Returns the amount of background workers.
+   */
+  inline std::size_t size() const {
+    return parent_ ? std::min(parent_->size(), limit_) : threads_.size();
+  }
+
+  /**
+   * @brief Execute fn(i) for all i in [0, n) and block until all are done.
+   * @param n           amount of work items
+   * @param fn          the work item function
+   * @param max_threads upper bound of threads working on this batch,
+   *                    including the calling thread, 0 means no limit
+   */
+  inline void parallelFor(const std::size_t n,
+                          const std::function<void(std::size_t)> &fn,
+                          const std::size_t max_threads = 0) {
+    if (n == 0) {
+      return;
+    }
+    if (parent_) {
+      const std::size_t threads =
+          max_threads > 0 ? std::min(max_threads, limit_ + 1) : limit_ + 1;
+      parent_->parallelFor(n, fn, threads);
+      return;
+    }
+    std::size_t helpers = std::min(threads_.size(), n - 1);
+    if (max_threads > 0) {
+      helpers = std::min(helpers, max_threads - 1);
+    }
+    if (helpers == 0) {
+      for (std::size_t i = 0; i < n; ++i) {
+        fn(i);
+      }
+      return;
+    }
+
+    auto batch = std::make_shared<Batch>(n, fn);
+    {
+      std::unique_lock<std::mutex> l{mutex_};
+      for (std::size_t i = 0; i < helpers; ++i) {
+        tasks_.emplace_back([batch]() { batch->run(); });
+      }
+    }
+    notify_.notify_all();
+
+    batch->run();
+    batch->wait();
+  }
+
+ private:
+  struct Batch {
+    inline Batch(const std::size_t n, const std::function<void(std::size_t)> &fn)
+        : n_{n}, fn_{fn}, next_{0}, done_{0} {}
+
+    inline void run() {
+      std::size_t i;
+      while ((i = next_++) < n_) {
+        try {
+          fn_(i);
+        } catch (...) {
+          std::unique_lock<std::mutex> l{mutex_};
+          if (!error_) {
+            error_ = std::current_exception();
+          }
+        }
+        if (++done_ == n_) {
+          std::unique_lock<std::mutex> l{mutex_};
+          finished_.notify_all();
+        }
+      }
+    }
+
+    inline void wait() {
+      std::unique_lock<std::mutex> l{mutex_};
+      finished_.wait(l, [this]() { return done_ == n_; });
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+    }
+
+    const std::size_t n_;
+    const std::function<void(std::size_t)> fn_;
+    std::atomic<std::size_t> next_;
+    std::atomic<std::size_t> done_;
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    std::exception_ptr error_;
+  };
+
+  Ptr parent_;              /// set for handles onto another pool
+  std::size_t limit_ = 0;   /// helpers of the parent pool per batch
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable notify_;
+  bool stop_;
+
+  inline void loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> l{mutex_};
+        notify_.wait(l, [this]() { return stop_ || !tasks_.empty(); });
+        if (stop_ && tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+};
+}  // namespace common
+}  // namespace cslibs_plugins_data
+
+#endif  // CSLIBS_PLUGINS_DATA_WORKER_POOL_HPP
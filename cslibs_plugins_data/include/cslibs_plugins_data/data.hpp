@@ -3,25 +3,77 @@
 
 #include <assert.h>
 
+#include <cslibs_plugins_data/common/frame_id.hpp>
 #include <cslibs_time/time_frame.hpp>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
 namespace cslibs_plugins_data {
+/**
+ * @brief Integral tags of the data types provided by this package, types
+ *        defined elsewhere are UNKNOWN.
+ */
+enum class DataType : uint8_t {
+  UNKNOWN = 0,
+  LASERSCAN2D,
+  LASERSCAN2F,
+  ODOMETRY2D,
+  ODOMETRY2F,
+  POINTCLOUD2D,
+  POINTCLOUD2F,
+  POINTCLOUD3D,
+  POINTCLOUD3F
+};
+
+namespace detail {
+template <typename... Ts>
+struct voider {
+  using type = void;
+};
+
+/**
+ * @brief True for types declaring their own tag, types deriving from a
+ *        tagged type are not tagged themselves.
+ */
+template <typename T, typename = void>
+struct is_tagged : std::false_type {};
+
+template <typename T>
+struct is_tagged<T, typename voider<typename T::tagged_t>::type>
+    : std::is_same<typename T::tagged_t, T> {};
+}  // namespace detail
+
 class Data {
  public:
   using Ptr = std::shared_ptr<Data>;
   using ConstPtr = std::shared_ptr<const Data>;
 
-  inline Data(const std::string &_frame) : frame_{_frame} {}
+  using frame_id_t = common::FrameId;
 
-  inline Data(const std::string &frame,
+  inline Data(const frame_id_t &_frame) : frame_{_frame} {}
+
+  inline Data(const frame_id_t &frame,
               const cslibs_time::TimeFrame &time_frame,
               const cslibs_time::Time &time_received)
       : frame_{frame}, time_frame_{time_frame}, time_received_{time_received} {}
 
+  inline Data(const DataType type, const frame_id_t &frame)
+      : type_{type}, frame_{frame} {}
+
+  inline Data(const DataType type, const frame_id_t &frame,
+              const cslibs_time::TimeFrame &time_frame,
+              const cslibs_time::Time &time_received)
+      : type_{type},
+        frame_{frame},
+        time_frame_{time_frame},
+        time_received_{time_received} {}
+
   virtual ~Data() = default;
 
-  inline std::string const &frame() const { return frame_; }
+  inline std::string const &frame() const { return frame_.name(); }
+
+  inline frame_id_t const &frameId() const { return frame_; }
 
   inline cslibs_time::TimeFrame const &timeFrame() const { return time_frame_; }
 
@@ -29,15 +81,22 @@ class Data {
     return time_received_;
   }
 
+  /**
+   * @brief The tag of the most derived tagged type this is an instance of.
+   */
+  inline DataType type() const { return type_; }
+
+  /**
+   * @brief Test the type, an integer comparison for tagged types.
+   */
   template <typename T>
   inline bool isType() const {
-    const T *t = dynamic_cast<const T *>(this);
-    return t != nullptr;
+    return isType<T>(detail::is_tagged<T>());
   }
 
   template <typename T>
   inline T const &as() const {
-    return dynamic_cast<const T &>(*this);
+    return as<T>(detail::is_tagged<T>());
   }
 
  protected:
@@ -45,9 +104,33 @@ class Data {
   inline Data(const Data &other) = default;
   inline Data(Data &&other) = default;
 
-  std::string frame_;
+  DataType type_ = DataType::UNKNOWN;
+  frame_id_t frame_;
   cslibs_time::TimeFrame time_frame_;
   cslibs_time::Time time_received_;
+
+ private:
+  template <typename T>
+  inline bool isType(std::true_type) const {
+    return type_ == T::staticType();
+  }
+
+  template <typename T>
+  inline bool isType(std::false_type) const {
+    const T *t = dynamic_cast<const T *>(this);
+    return t != nullptr;
+  }
+
+  template <typename T>
+  inline T const &as(std::true_type) const {
+    return type_ == T::staticType() ? static_cast<const T &>(*this)
+                                    : dynamic_cast<const T &>(*this);
+  }
+
+  template <typename T>
+  inline T const &as(std::false_type) const {
+    return dynamic_cast<const T &>(*this);
+  }
 };
 }  // namespace cslibs_plugins_data
 
@@ -1,15 +1,26 @@
 #ifndef CSLIBS_PLUGINS_DATA_PROVIDER_HPP
 #define CSLIBS_PLUGINS_DATA_PROVIDER_HPP
 
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros/callback_queue.h>
+#include <ros/console.h>
 #include <ros/node_handle.h>
 
 #include <cslibs_math_ros/tf/tf_provider.hpp>
 #include <cslibs_plugins/common/plugin.hpp>
+#include <cslibs_plugins_data/common/async_connection.hpp>
+#include <cslibs_plugins_data/common/executor.hpp>
+#include <cslibs_plugins_data/common/provider_stats.hpp>
+#include <cslibs_plugins_data/common/queue_spinner.hpp>
+#include <cslibs_plugins_data/common/thread_settings.hpp>
 #include <cslibs_plugins_data/data.hpp>
 #include <cslibs_utility/common/delegate.hpp>
 #include <cslibs_utility/signals/signals.hpp>
 #include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace cslibs_plugins_data {
 class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
@@ -18,18 +29,22 @@ class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
 
   using callback_t =
       cslibs_utility::common::delegate<void(const Data::ConstPtr &)>;
+  template <typename T>
+  using typed_callback_t = cslibs_utility::common::delegate<void(const T &)>;
   using signal_t = cslibs_utility::signals::Signal<callback_t>;
   using connection_t = signal_t::Connection;
+  using async_connection_t = common::AsyncConnection;
   using tf_provider_t = cslibs_math_ros::tf::TFProvider;
+  using stats_t = common::ProviderStats;
 
   /**
    * @brief the default constructor
    */
   inline DataProvider() = default;
   /**
-   * @brief the default destructor
+   * @brief the destructor stopping a dedicated spinner
    */
-  virtual ~DataProvider() = default;
+  virtual ~DataProvider() { shutdown(); }
 
   /**
    * @brief Returns the type as string for the pluginlib.
@@ -41,19 +56,33 @@ class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
 
   /**
    * @brief Set up the data provider by passing a tf provider and ROS node handle.
+   *        If the parameter spinner_threads is greater than zero, the provider
+   *        gets its own callback queue served by that many threads. The
+   *        parameters cpus, fifo_priority and nice set the affinity and
+   *        scheduling of these and other threads owned by the provider. If
+   *        the parameter stats_period is greater than zero, the provider's
+   *        statistics are published on /diagnostics with that period.
    * @param tf      the tf provider
    * @param nh      the ros node handle
    */
   inline void setup(const typename tf_provider_t::Ptr &tf,
                     ros::NodeHandle &nh) {
-    auto param_name = [this](const std::string &name) {
-      return name_ + "/" + name;
-    };
+    setupHandles(tf, nh, nh, false);
+  }
 
-    tf_ = tf;
-    tf_timeout_ =
-        ros::Duration(nh.param<double>(param_name("tf_timeout"), 0.1));
-    doSetup(nh);
+  /**
+   * @brief Set up the data provider inside a nodelet. Topics are resolved by
+   *        the nodelet's node handle, parameters are read from its private
+   *        node handle. Messages published within the same nodelet manager
+   *        are handed over as shared pointers without serialization, so
+   *        subscription paths depending on serialization are disabled.
+   * @param tf          the tf provider
+   * @param nh          the nodelet's (multi threaded) node handle
+   * @param private_nh  the nodelet's private node handle
+   */
+  inline void setup(const typename tf_provider_t::Ptr &tf, ros::NodeHandle &nh,
+                    ros::NodeHandle &private_nh) {
+    setupHandles(tf, nh, private_nh, true);
   }
 
   /**
@@ -66,6 +95,57 @@ class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
     return data_received_.connect(callback);
   }
 
+  /**
+   * @brief Connect to data provider with a callback for one data type, which
+   *        is checked against the provider's output type once instead of
+   *        casting every message. Providers of unknown output type pass on
+   *        data of the requested type only.
+   * @param callback    function to call
+   * @return connection for a given callback
+   * @throws std::runtime_error if the provider outputs a different type
+   */
+  template <typename T>
+  connection_t::Ptr connect(const typed_callback_t<T> &callback) {
+    static_assert(detail::is_tagged<T>::value,
+                  "Typed connections require a data type with a tag.");
+    const DataType type = T::staticType();
+    const DataType output = outputType();
+    if (output != DataType::UNKNOWN && output != type) {
+      throw std::runtime_error("[DataProvider]: '" + name_ +
+                               "' does not provide the requested type!");
+    }
+    return data_received_.connect(
+        callback_t([callback, type](const Data::ConstPtr &data) {
+          if (data->type() == type) {
+            callback(static_cast<const T &>(*data));
+          }
+        }));
+  }
+
+  /**
+   * @brief Connect to data provider through a bounded queue drained by a
+   *        dedicated worker, so that slow consumers do not delay the
+   *        provider or other consumers. The worker runs with the provider's
+   *        affinity and scheduling. Callback will be executed as long as
+   *        the connection object is alive.
+   * @param callback    function to call
+   * @param options     queue size and overflow policy
+   * @return connection exposing queue depth and drop counters
+   */
+  async_connection_t::Ptr connect(const callback_t &callback,
+                                  const async_connection_t::Options &options) {
+    /// the worker starts asynchronously and may outlive the provider
+    const common::ThreadSettings settings = thread_settings_;
+    const std::string name = name_;
+    async_connection_t::Ptr connection{new async_connection_t{
+        callback, options,
+        [settings, name]() { applyThreadSettings(settings, name); }}};
+    async_connection_t *relay = connection.get();
+    connection->attach(data_received_.connect(
+        callback_t([relay](const Data::ConstPtr &data) { relay->push(data); })));
+    return connection;
+  }
+
   /**
    * @brief Enable data to be pushed through.
    */
@@ -76,6 +156,23 @@ class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
    */
   void disable() { data_received_.disable(); }
 
+  /**
+   * @brief Emit data which has been accumulated but not pushed through yet.
+   *        Providers that do not accumulate ignore this.
+   */
+  virtual void flush() {}
+
+  /**
+   * @brief The type of the data this provider outputs, UNKNOWN if it is not
+   *        tagged or not fixed.
+   */
+  virtual DataType outputType() const { return DataType::UNKNOWN; }
+
+  /**
+   * @brief Latency histograms and message counters of this provider.
+   */
+  inline const stats_t &stats() const { return stats_; }
+
   /**
    * @brief Test if publisher has a certain type.
    */
@@ -103,11 +200,208 @@ class DataProvider : public cslibs_plugins::Plugin<DataProvider> {
 
  protected:
   signal_t data_received_;
+  stats_t stats_;
 
   typename tf_provider_t::Ptr tf_;
   ros::Duration tf_timeout_;
 
+  std::unique_ptr<ros::CallbackQueue> callback_queue_;
+  std::unique_ptr<common::QueueSpinner> spinner_;
+
+  common::ThreadSettings thread_settings_;
+  common::Executor::Ptr executor_;
+
+  ros::Publisher stats_pub_;
+  ros::WallTimer stats_timer_;
+
+  bool intra_process_ = false;
+
   virtual void doSetup(ros::NodeHandle &nh) = 0;
+
+  /**
+   * @brief Stop the statistics timer and the dedicated spinner and discard
+   *        queued callbacks. The base destructor only runs after the members
+   *        of derived providers are destroyed, so leaf destructors call this
+   *        before tearing down anything their callbacks use.
+   */
+  inline void shutdown() {
+    stats_timer_.stop();
+    spinner_.reset();
+    if (callback_queue_) {
+      callback_queue_->disable();
+      callback_queue_->clear();
+    }
+  }
+
+  /**
+   * @brief Set up with separate handles for topics and parameters. Providers
+   *        not overriding this are set up with the private handle only.
+   * @param nh          node handle to subscribe with
+   * @param private_nh  node handle to read parameters from
+   */
+  virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) {
+    (void)nh;
+    doSetup(private_nh);
+  }
+
+  /**
+   * @brief Test if messages may be throttled before deserialization, which
+   *        requires them to arrive serialized.
+   */
+  inline bool throttleSerialized(const ros::NodeHandle &private_nh) const {
+    return !intra_process_ &&
+           private_nh.param<bool>(name_ + "/throttle_serialized", true);
+  }
+
+  /**
+   * @brief Apply the provider's affinity and scheduling to the calling
+   *        thread, to be called first by threads the provider owns.
+   */
+  inline void applyThreadSettings() {
+    applyThreadSettings(thread_settings_, name_);
+  }
+
+  inline static void applyThreadSettings(
+      const common::ThreadSettings &settings, const std::string &name) {
+    std::string error;
+    if (!settings.empty() && !settings.apply(error)) {
+      ROS_WARN_STREAM(name << ": " << error);
+    }
+  }
+
+  /**
+   * @brief The executor for background work, the process wide one unless
+   *        affinity or scheduling is set, then one of the provider's own.
+   */
+  inline common::Executor::Ptr executor() {
+    if (!executor_) {
+      executor_ = thread_settings_.empty()
+                      ? common::Executor::shared()
+                      : std::make_shared<common::Executor>(
+                            1, [this]() { applyThreadSettings(); });
+    }
+    return executor_;
+  }
+
+  /**
+   * @brief Count a received message and record its transport delay.
+   * @param stamp   the message's header stamp
+   */
+  inline void recordReceived(const ros::Time &stamp) {
+    stats_.received.fetch_add(1, std::memory_order_relaxed);
+    stats_.transport.record(
+        static_cast<int64_t>(ros::Time::now().toNSec()) -
+        static_cast<int64_t>(stamp.toNSec()));
+  }
+
+  /**
+   * @brief Push data through to all consumers and record the dispatch time.
+   */
+  inline void emit(const Data::ConstPtr &data) {
+    {
+      stats_t::ScopedTimer timer{stats_.dispatch};
+      data_received_(data);
+    }
+    stats_.emitted.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  inline void setupHandles(const typename tf_provider_t::Ptr &tf,
+                           ros::NodeHandle &nh, ros::NodeHandle &private_nh,
+                           const bool nodelet) {
+    auto param_name = [this](const std::string &name) {
+      return name_ + "/" + name;
+    };
+
+    tf_ = tf;
+    tf_timeout_ = ros::Duration(
+        private_nh.param<double>(param_name("tf_timeout"), 0.1));
+    intra_process_ =
+        nodelet && private_nh.param<bool>(param_name("intra_process"), true);
+
+    /// process wide, only effective before background work is first scheduled
+    const int executor_threads = private_nh.param<int>("executor_threads", 0);
+    if (executor_threads > 0 &&
+        !common::Executor::configure(
+            static_cast<std::size_t>(executor_threads))) {
+      ROS_WARN_STREAM(name_ << ": Executor already running with "
+                            << common::Executor::shared()->size()
+                            << " threads, ignoring executor_threads.");
+    }
+
+    thread_settings_.cpus = private_nh.param<std::vector<int>>(
+        param_name("cpus"), std::vector<int>());
+    thread_settings_.fifo_priority =
+        private_nh.param<int>(param_name("fifo_priority"), 0);
+    thread_settings_.nice = private_nh.param<int>(param_name("nice"), 0);
+
+    const int spinner_threads =
+        private_nh.param<int>(param_name("spinner_threads"), 0);
+    if (spinner_threads > 0) {
+      callback_queue_.reset(new ros::CallbackQueue);
+      ros::NodeHandle queued_nh{nh};
+      ros::NodeHandle queued_private_nh{private_nh};
+      queued_nh.setCallbackQueue(callback_queue_.get());
+      queued_private_nh.setCallbackQueue(callback_queue_.get());
+      if (nodelet) {
+        doSetup(queued_nh, queued_private_nh);
+      } else {
+        doSetup(queued_nh);
+      }
+
+      spinner_.reset(new common::QueueSpinner(
+          *callback_queue_, static_cast<std::size_t>(spinner_threads),
+          [this]() { applyThreadSettings(); }));
+    } else if (nodelet) {
+      doSetup(nh, private_nh);
+    } else {
+      doSetup(nh);
+    }
+
+    const double stats_period =
+        private_nh.param<double>(param_name("stats_period"), 0.0);
+    if (stats_period > 0.0) {
+      stats_pub_ =
+          nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+      stats_timer_ = nh.createWallTimer(ros::WallDuration(stats_period),
+                                        &DataProvider::publishStats, this);
+    }
+  }
+
+  void publishStats(const ros::WallTimerEvent &) {
+    const stats_t::Snapshot s = stats_.snapshot();
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = name_;
+    status.message = "data provider statistics";
+    auto add = [&status](const std::string &key, const uint64_t value) {
+      diagnostic_msgs::KeyValue kv;
+      kv.key = key;
+      kv.value = std::to_string(value);
+      status.values.emplace_back(kv);
+    };
+    auto add_histogram = [&add](const std::string &key,
+                                const common::LatencyHistogram::Snapshot &h) {
+      add(key + " mean [ns]", static_cast<uint64_t>(h.mean()));
+      add(key + " p50 [ns]", h.quantile(0.5));
+      add(key + " p99 [ns]", h.quantile(0.99));
+      add(key + " max [ns]", h.max_ns);
+    };
+    add("received", s.received);
+    add("throttled", s.throttled);
+    add("failed tf", s.failed_tf);
+    add("emitted", s.emitted);
+    add_histogram("transport", s.transport);
+    add_histogram("tf wait", s.tf_wait);
+    add_histogram("conversion", s.conversion);
+    add_histogram("dispatch", s.dispatch);
+    add_histogram("jitter", s.jitter);
+
+    diagnostic_msgs::DiagnosticArray msg;
+    msg.header.stamp = ros::Time::now();
+    msg.status.emplace_back(status);
+    stats_pub_.publish(msg);
+  }
 };
 }  // namespace cslibs_plugins_data
 
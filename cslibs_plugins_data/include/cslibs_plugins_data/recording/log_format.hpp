@@ -0,0 +1,86 @@
+#ifndef CSLIBS_PLUGINS_DATA_RECORDING_LOG_FORMAT_HPP
+#define CSLIBS_PLUGINS_DATA_RECORDING_LOG_FORMAT_HPP
+
+#include <cstdint>
+
+/**
+ * Binary data log layout, all values in host byte order:
+ *
+ *   FileHeader
+ *   ChunkHeader, chunk payload (records, optionally LZ4 compressed)
+ *   ...
+ *   IndexHeader, IndexEntry * count
+ *   Footer
+ *
+ * Chunks are only appended, the index and footer are written on close. Logs
+ * without footer, e.g. after a crash, are recovered by scanning the chunks.
+ * A chunk payload is a sequence of records, each made of a RecordHeader
+ * followed by the frame name and the type specific payload.
+ */
+namespace cslibs_plugins_data {
+namespace recording {
+constexpr char     FILE_MAGIC[8]   = {'C', 'S', 'P', 'D', 'L', 'O', 'G', '\0'};
+constexpr char     FOOTER_MAGIC[8] = {'C', 'S', 'P', 'D', 'I', 'D', 'X', '\0'};
+constexpr uint32_t CHUNK_MAGIC     = 0x4b4e4843u;   /// "CHNK"
+constexpr uint32_t INDEX_MAGIC     = 0x58444e49u;   /// "INDX"
+constexpr uint32_t VERSION         = 1u;
+
+constexpr uint32_t CHUNK_FLAG_LZ4  = 1u;
+
+enum class RecordType : uint8_t {
+    UNKNOWN     = 0,
+    LASERSCAN2  = 1,
+    ODOMETRY2   = 2,
+    POINTCLOUD2 = 3,
+    POINTCLOUD3 = 4
+};
+
+struct FileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;
+};
+
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t raw_size;
+    uint64_t stored_size;
+    uint32_t records;
+    uint32_t reserved;
+    int64_t  stamp_min;         /// minimum received stamp in ns
+    int64_t  stamp_max;         /// maximum received stamp in ns
+};
+
+struct RecordHeader {
+    uint8_t  type;
+    uint8_t  scalar_size;       /// 4 for float, 8 for double
+    uint16_t frame_size;
+    uint32_t payload_size;
+    int64_t  start;             /// time frame start in ns
+    int64_t  end;               /// time frame end in ns
+    int64_t  received;          /// received stamp in ns
+};
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+struct IndexEntry {
+    uint64_t offset;            /// file offset of the chunk header
+    int64_t  stamp_min;
+    int64_t  stamp_max;
+    uint32_t records;
+    uint32_t reserved;
+};
+
+struct Footer {
+    uint64_t index_offset;
+    char     magic[8];
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_RECORDING_LOG_FORMAT_HPP
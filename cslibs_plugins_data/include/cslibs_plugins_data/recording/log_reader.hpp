@@ -0,0 +1,89 @@
+#ifndef CSLIBS_PLUGINS_DATA_RECORDING_LOG_READER_HPP
+#define CSLIBS_PLUGINS_DATA_RECORDING_LOG_READER_HPP
+
+#include <cslibs_plugins_data/data.hpp>
+#include <cslibs_plugins_data/recording/log_format.hpp>
+#include <cslibs_plugins_data/recording/serialization.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace recording {
+/**
+ * @brief The LogReader class memory maps a log written by LogWriter and
+ *        iterates its records in order. Records of uncompressed chunks refer
+ *        directly to the mapped file and stay valid as long as the reader.
+ */
+class LogReader
+{
+public:
+    using Ptr = std::shared_ptr<LogReader>;
+
+    /**
+     * @brief Open a log, throws std::runtime_error on failure.
+     * @param path      - path of the log file
+     */
+    explicit LogReader(const std::string &path);
+    virtual ~LogReader();
+
+    LogReader(const LogReader &other) = delete;
+    LogReader& operator = (const LogReader &other) = delete;
+
+    inline std::size_t chunks() const
+    {
+        return index_.size();
+    }
+
+    std::size_t records() const;
+
+    /**
+     * @brief Received stamp of the first and last record in ns.
+     */
+    int64_t startStamp() const;
+    int64_t endStamp() const;
+
+    /**
+     * @brief Restart reading at the first record.
+     */
+    void rewind();
+
+    /**
+     * @brief Continue reading at the first record received at or after the stamp.
+     * @param stamp     - received stamp in ns
+     */
+    void seek(const int64_t stamp);
+
+    /**
+     * @brief Read the next record without decoding it.
+     * @return false at the end of the log
+     */
+    bool next(Record &record);
+
+    /**
+     * @brief Read and decode the next record, unsupported records are skipped.
+     * @return false at the end of the log
+     */
+    bool next(Data::ConstPtr &data);
+
+private:
+    int                     fd_;
+    const uint8_t          *map_;
+    std::size_t             size_;
+    std::vector<IndexEntry> index_;
+
+    std::size_t                 chunk_;         /// current chunk
+    std::size_t                 record_;        /// current record in chunk
+    std::size_t                 offset_;        /// current offset in chunk payload
+    const uint8_t              *payload_;       /// current chunk payload
+    std::size_t                 payload_size_;
+    std::shared_ptr<const void> storage_;       /// decompressed payload
+
+    void buildIndex();
+    bool loadChunk(const std::size_t chunk);
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_RECORDING_LOG_READER_HPP
@@ -0,0 +1,118 @@
+#ifndef CSLIBS_PLUGINS_DATA_RECORDING_LOG_WRITER_HPP
+#define CSLIBS_PLUGINS_DATA_RECORDING_LOG_WRITER_HPP
+
+#include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/recording/log_format.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace recording {
+/**
+ * @brief The LogWriter class records data as converted by the providers into an
+ *        append-only, chunk indexed binary log.
+ */
+class LogWriter
+{
+public:
+    using Ptr = std::shared_ptr<LogWriter>;
+
+    struct Options {
+        std::size_t chunk_size = 1ul << 20;     /// uncompressed bytes per chunk
+        bool        compress   = false;         /// LZ4 compression, if available
+    };
+
+    /**
+     * @brief Create a new log, an existing file is replaced.
+     * @param path      - path of the log file
+     * @param options   - chunk size and compression
+     */
+    LogWriter(const std::string &path,
+              const Options     &options);
+    explicit LogWriter(const std::string &path);
+    virtual ~LogWriter();
+
+    LogWriter(const LogWriter &other) = delete;
+    LogWriter& operator = (const LogWriter &other) = delete;
+
+    /**
+     * @brief Append a data object, safe to be called from multiple threads.
+     *        Never throws, if writing to disk fails the log is closed and
+     *        recording stops, see failed(). Data with a frame name longer than
+     *        65535 bytes is skipped, see skipped().
+     * @return false if the data type is not supported, the frame name is too
+     *         long, the log is closed or writing failed
+     */
+    bool write(const Data &data);
+
+    /**
+     * @brief Write the current chunk to disk.
+     */
+    void flush();
+
+    /**
+     * @brief Flush and write the chunk index, afterwards no data is accepted.
+     */
+    void close();
+
+    /**
+     * @brief Test if writing to disk failed, the log is incomplete then.
+     */
+    bool failed() const;
+
+    /**
+     * @brief Amount of data skipped because its frame name was too long.
+     */
+    std::size_t skipped() const;
+
+    /**
+     * @brief Record everything a provider emits. Writing happens on the worker
+     *        of the returned connection, recording stops once it is released,
+     *        which has to happen before the writer is destroyed.
+     *        By default the oldest queued data is dropped if the disk cannot
+     *        keep up, so recording never stalls the provider's callbacks. The
+     *        connection counts the drops, see AsyncConnection::dropped().
+     *        Pass OverflowPolicy::BLOCK to record without loss instead, the
+     *        provider then waits for the disk whenever the queue is full.
+     * @param provider  - the data provider to record
+     * @param options   - queue options
+     */
+    DataProvider::async_connection_t::Ptr attach(DataProvider &provider,
+                                                 const DataProvider::async_connection_t::Options &options = defaultQueueOptions());
+
+    static DataProvider::async_connection_t::Options defaultQueueOptions();
+
+    inline static bool compressionAvailable()
+    {
+#ifdef CSLIBS_PLUGINS_DATA_WITH_LZ4
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    Options                 options_;
+    std::FILE              *file_;
+    bool                    failed_;
+    std::size_t             skipped_;
+    mutable std::mutex      mutex_;
+    std::vector<uint8_t>    chunk_;
+    uint32_t                chunk_records_;
+    int64_t                 chunk_stamp_min_;
+    int64_t                 chunk_stamp_max_;
+    std::vector<IndexEntry> index_;
+    std::vector<uint8_t>    payload_;
+
+    bool writeChunk();
+    bool writeBytes(const void *data, const std::size_t size);
+    void fail();
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_RECORDING_LOG_WRITER_HPP
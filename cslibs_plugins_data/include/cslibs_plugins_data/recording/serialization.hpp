@@ -0,0 +1,359 @@
+#ifndef CSLIBS_PLUGINS_DATA_RECORDING_SERIALIZATION_HPP
+#define CSLIBS_PLUGINS_DATA_RECORDING_SERIALIZATION_HPP
+
+#include <cslibs_plugins_data/recording/log_format.hpp>
+#include <cslibs_plugins_data/types/laserscan.hpp>
+#include <cslibs_plugins_data/types/odometry_2d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_2d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d.hpp>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace recording {
+/**
+ * @brief The Record struct refers to a single record inside a log. For
+ *        uncompressed chunks frame and payload point directly into the mapped
+ *        file, otherwise into a decompressed buffer kept alive by storage.
+ */
+struct Record {
+    RecordHeader                header;
+    const char                 *frame   = nullptr;
+    const uint8_t              *payload = nullptr;
+    std::shared_ptr<const void> storage;
+
+    inline std::string frameName() const
+    {
+        return std::string(frame, header.frame_size);
+    }
+
+    inline RecordType type() const
+    {
+        return static_cast<RecordType>(header.type);
+    }
+};
+
+class PayloadWriter
+{
+public:
+    inline explicit PayloadWriter(std::vector<uint8_t> &buffer) :
+        buffer_(buffer)
+    {
+    }
+
+    template <typename V>
+    inline void put(const V v)
+    {
+        const std::size_t pos = buffer_.size();
+        buffer_.resize(pos + sizeof(V));
+        std::memcpy(buffer_.data() + pos, &v, sizeof(V));
+    }
+
+private:
+    std::vector<uint8_t> &buffer_;
+};
+
+class PayloadReader
+{
+public:
+    inline PayloadReader(const uint8_t *data, const std::size_t size) :
+        pos_(data),
+        end_(data + size)
+    {
+    }
+
+    template <typename V>
+    inline V get()
+    {
+        if (pos_ + sizeof(V) > end_)
+            throw std::runtime_error("[PayloadReader]: Record payload is truncated!");
+        V v;
+        std::memcpy(&v, pos_, sizeof(V));
+        pos_ += sizeof(V);
+        return v;
+    }
+
+    inline bool atEnd() const
+    {
+        return pos_ >= end_;
+    }
+
+private:
+    const uint8_t *pos_;
+    const uint8_t *end_;
+};
+
+namespace detail {
+/// optional sections following the rays of a laser scan, absent in older logs
+constexpr uint32_t LASERSCAN_SECTION_ECHOES            = 1u;
+constexpr uint32_t LASERSCAN_SECTION_INTENSITIES       = 2u;
+constexpr uint32_t LASERSCAN_SECTION_ECHO_INTENSITIES  = 4u;
+
+template <typename T>
+inline void encodeRay(const typename types::Laserscan2<T>::Ray &ray, PayloadWriter &w)
+{
+    w.put<T>(ray.angle);
+    w.put<T>(ray.range);
+    w.put<T>(ray.end_point(0));
+    w.put<T>(ray.end_point(1));
+    w.put<T>(ray.start_point(0));
+    w.put<T>(ray.start_point(1));
+}
+
+template <typename T>
+inline typename types::Laserscan2<T>::Ray decodeRay(PayloadReader &reader)
+{
+    using point_t = typename types::Laserscan2<T>::point_t;
+    const T angle = reader.get<T>();
+    const T range = reader.get<T>();
+    const T ex    = reader.get<T>();
+    const T ey    = reader.get<T>();
+    const T sx    = reader.get<T>();
+    const T sy    = reader.get<T>();
+    return typename types::Laserscan2<T>::Ray(angle, range, point_t(ex, ey), point_t(sx, sy));
+}
+
+template <typename T>
+inline void encode(const types::Laserscan2<T> &scan, PayloadWriter &w)
+{
+    w.put<T>(scan.getLinearMin());
+    w.put<T>(scan.getLinearMax());
+    w.put<T>(scan.getAngularMin());
+    w.put<T>(scan.getAngularMax());
+    w.put<uint32_t>(static_cast<uint32_t>(scan.getRays().size()));
+    for (const auto &ray : scan.getRays())
+        encodeRay<T>(ray, w);
+
+    const uint32_t sections = (scan.hasEchoes()          ? LASERSCAN_SECTION_ECHOES           : 0u) |
+                              (scan.hasIntensities()     ? LASERSCAN_SECTION_INTENSITIES      : 0u) |
+                              (scan.hasEchoIntensities() ? LASERSCAN_SECTION_ECHO_INTENSITIES : 0u);
+    if (sections == 0u)
+        return;
+    w.put<uint32_t>(sections);
+    if (sections & LASERSCAN_SECTION_INTENSITIES) {
+        for (const auto intensity : scan.getIntensities())
+            w.put<T>(intensity);
+    }
+    if (sections & LASERSCAN_SECTION_ECHOES) {
+        w.put<uint32_t>(static_cast<uint32_t>(scan.getBeamCount()));
+        for (const auto offset : scan.getEchoOffsets())
+            w.put<uint32_t>(static_cast<uint32_t>(offset));
+        for (const auto &echo : scan.getAllEchoes())
+            encodeRay<T>(echo, w);
+    }
+    if (sections & LASERSCAN_SECTION_ECHO_INTENSITIES) {
+        for (const auto intensity : scan.getAllEchoIntensities())
+            w.put<T>(intensity);
+    }
+}
+
+template <typename T>
+inline void encode(const types::Odometry2<T> &odometry, PayloadWriter &w)
+{
+    for (const auto *pose : {&odometry.getStartPose(), &odometry.getEndPose()}) {
+        w.put<T>(pose->tx());
+        w.put<T>(pose->ty());
+        w.put<T>(pose->yaw());
+    }
+}
+
+template <typename T>
+inline void encode(const types::Pointcloud2<T> &pointcloud, PayloadWriter &w)
+{
+    const auto points = pointcloud.points();
+    w.put<uint32_t>(points ? static_cast<uint32_t>(points->size()) : 0u);
+    if (points) {
+        for (const auto &p : *points) {
+            w.put<T>(p(0));
+            w.put<T>(p(1));
+        }
+    }
+}
+
+template <typename T>
+inline void encode(const types::Pointcloud3<T> &pointcloud, PayloadWriter &w)
+{
+    const auto points = pointcloud.points();
+    w.put<uint32_t>(points ? static_cast<uint32_t>(points->size()) : 0u);
+    if (points) {
+        for (const auto &p : *points) {
+            w.put<T>(p(0));
+            w.put<T>(p(1));
+            w.put<T>(p(2));
+        }
+    }
+}
+
+template <typename T>
+inline Data::ConstPtr decodeLaserscan2(const Record &r, const cslibs_time::TimeFrame &time_frame, const cslibs_time::Time &received)
+{
+    PayloadReader reader(r.payload, r.header.payload_size);
+    const T linear_min  = reader.get<T>();
+    const T linear_max  = reader.get<T>();
+    const T angular_min = reader.get<T>();
+    const T angular_max = reader.get<T>();
+    typename types::Laserscan2<T>::Ptr scan(new types::Laserscan2<T>(r.frameName(), time_frame,
+                                                                     {linear_min, linear_max},
+                                                                     {angular_min, angular_max},
+                                                                     received));
+    const uint32_t n = reader.get<uint32_t>();
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        const auto ray = decodeRay<T>(reader);
+        scan->insert(ray.angle, ray.range, ray.end_point, ray.start_point);
+    }
+    if (reader.atEnd())
+        return scan;
+
+    const uint32_t sections = reader.get<uint32_t>();
+    if (sections & LASERSCAN_SECTION_INTENSITIES) {
+        scan->reserveIntensities(n);
+        for (uint32_t i = 0 ; i < n ; ++i)
+            scan->insertIntensity(reader.get<T>());
+    }
+    if (sections & LASERSCAN_SECTION_ECHOES) {
+        const uint32_t beams = reader.get<uint32_t>();
+        std::vector<uint32_t> offsets(beams + 1u);
+        for (auto &offset : offsets)
+            offset = reader.get<uint32_t>();
+        scan->reserveEchoes(beams, offsets.back());
+        for (uint32_t b = 0 ; b < beams ; ++b) {
+            for (uint32_t e = offsets[b] ; e < offsets[b + 1] ; ++e) {
+                const auto echo = decodeRay<T>(reader);
+                scan->insertEcho(echo.angle, echo.range, echo.end_point, echo.start_point);
+            }
+            scan->closeBeam();
+        }
+    }
+    if (sections & LASERSCAN_SECTION_ECHO_INTENSITIES) {
+        const std::size_t echoes = scan->getAllEchoes().size();
+        scan->reserveEchoIntensities(echoes);
+        for (std::size_t i = 0 ; i < echoes ; ++i)
+            scan->insertEchoIntensity(reader.get<T>());
+    }
+    return scan;
+}
+
+template <typename T>
+inline Data::ConstPtr decodeOdometry2(const Record &r, const cslibs_time::TimeFrame &time_frame, const cslibs_time::Time &received)
+{
+    using transform_t = typename types::Odometry2<T>::transform_t;
+    PayloadReader reader(r.payload, r.header.payload_size);
+    const T sx   = reader.get<T>();
+    const T sy   = reader.get<T>();
+    const T syaw = reader.get<T>();
+    const T ex   = reader.get<T>();
+    const T ey   = reader.get<T>();
+    const T eyaw = reader.get<T>();
+    return typename types::Odometry2<T>::Ptr(new types::Odometry2<T>(r.frameName(), time_frame,
+                                                                     transform_t(sx, sy, syaw),
+                                                                     transform_t(ex, ey, eyaw),
+                                                                     received));
+}
+
+template <typename T>
+inline Data::ConstPtr decodePointcloud2(const Record &r, const cslibs_time::TimeFrame &time_frame, const cslibs_time::Time &received)
+{
+    using cloud_t = typename types::Pointcloud2<T>::cloud_t;
+    PayloadReader reader(r.payload, r.header.payload_size);
+    typename types::Pointcloud2<T>::Ptr pointcloud(new types::Pointcloud2<T>(r.frameName(), time_frame, received));
+    pointcloud->points().reset(new cloud_t);
+    const uint32_t n = reader.get<uint32_t>();
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        const T x = reader.get<T>();
+        const T y = reader.get<T>();
+        pointcloud->points()->insert(cslibs_math_2d::Point2<T>(x, y));
+    }
+    return pointcloud;
+}
+
+template <typename T>
+inline Data::ConstPtr decodePointcloud3(const Record &r, const cslibs_time::TimeFrame &time_frame, const cslibs_time::Time &received)
+{
+    using cloud_t = typename types::Pointcloud3<T>::cloud_t;
+    PayloadReader reader(r.payload, r.header.payload_size);
+    typename types::Pointcloud3<T>::Ptr pointcloud(new types::Pointcloud3<T>(r.frameName(), time_frame, received));
+    pointcloud->points().reset(new cloud_t);
+    const uint32_t n = reader.get<uint32_t>();
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        const T x = reader.get<T>();
+        const T y = reader.get<T>();
+        const T z = reader.get<T>();
+        pointcloud->points()->insert(cslibs_math_3d::Point3<T>(x, y, z));
+    }
+    return pointcloud;
+}
+
+template <template <typename> class Type, typename T>
+inline bool tryEncode(const Data &data, const RecordType type, RecordHeader &header, PayloadWriter &w)
+{
+    if (!data.isType<Type<T>>())
+        return false;
+    header.type        = static_cast<uint8_t>(type);
+    header.scalar_size = sizeof(T);
+    encode(data.as<Type<T>>(), w);
+    return true;
+}
+}
+
+/**
+ * @brief Serialize a data object, the frame name is not part of the payload.
+ * @param data      - the data to serialize
+ * @param header    - record header to fill, payload size excluded
+ * @param payload   - buffer the payload is appended to
+ * @return false if the data type is not supported
+ */
+inline bool encode(const Data          &data,
+                   RecordHeader         &header,
+                   std::vector<uint8_t> &payload)
+{
+    PayloadWriter w(payload);
+    header.start    = static_cast<int64_t>(data.timeFrame().start.nanoseconds());
+    header.end      = static_cast<int64_t>(data.timeFrame().end.nanoseconds());
+    header.received = static_cast<int64_t>(data.stampReceived().nanoseconds());
+    return detail::tryEncode<types::Laserscan2,  double>(data, RecordType::LASERSCAN2,  header, w) ||
+           detail::tryEncode<types::Laserscan2,  float >(data, RecordType::LASERSCAN2,  header, w) ||
+           detail::tryEncode<types::Odometry2,   double>(data, RecordType::ODOMETRY2,   header, w) ||
+           detail::tryEncode<types::Odometry2,   float >(data, RecordType::ODOMETRY2,   header, w) ||
+           detail::tryEncode<types::Pointcloud2, double>(data, RecordType::POINTCLOUD2, header, w) ||
+           detail::tryEncode<types::Pointcloud2, float >(data, RecordType::POINTCLOUD2, header, w) ||
+           detail::tryEncode<types::Pointcloud3, double>(data, RecordType::POINTCLOUD3, header, w) ||
+           detail::tryEncode<types::Pointcloud3, float >(data, RecordType::POINTCLOUD3, header, w);
+}
+
+/**
+ * @brief Reconstruct a data object from a record.
+ * @param record    - the record
+ * @return the data object, null for unknown record types
+ */
+inline Data::ConstPtr decode(const Record &record)
+{
+    const cslibs_time::TimeFrame time_frame(cslibs_time::Time(record.header.start),
+                                            cslibs_time::Time(record.header.end));
+    const cslibs_time::Time      received(record.header.received);
+    const bool is_double = record.header.scalar_size == sizeof(double);
+
+    switch (record.type()) {
+    case RecordType::LASERSCAN2:
+        return is_double ? detail::decodeLaserscan2<double>(record, time_frame, received) :
+                           detail::decodeLaserscan2<float>(record, time_frame, received);
+    case RecordType::ODOMETRY2:
+        return is_double ? detail::decodeOdometry2<double>(record, time_frame, received) :
+                           detail::decodeOdometry2<float>(record, time_frame, received);
+    case RecordType::POINTCLOUD2:
+        return is_double ? detail::decodePointcloud2<double>(record, time_frame, received) :
+                           detail::decodePointcloud2<float>(record, time_frame, received);
+    case RecordType::POINTCLOUD3:
+        return is_double ? detail::decodePointcloud3<double>(record, time_frame, received) :
+                           detail::decodePointcloud3<float>(record, time_frame, received);
+    default:
+        return Data::ConstPtr();
+    }
+}
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_RECORDING_SERIALIZATION_HPP
@@ -6,6 +6,7 @@
 #include <cslibs_math_2d/linear/point.hpp>
 #include <cslibs_time/time_frame.hpp>
 
+#include <iterator>
 #include <limits>
 #include <vector>
 
@@ -21,6 +22,12 @@ public:
     using point_t       = cslibs_math_2d::Point2<T>;
     using time_frame_t  = cslibs_time::TimeFrame;
     using interval_t    = std::array<T, 2>;
+    using tagged_t      = Laserscan2<T>;
+
+    inline static constexpr DataType staticType()
+    {
+        return std::is_same<T, double>::value ? DataType::LASERSCAN2D : DataType::LASERSCAN2F;
+    }
 
     /**
      * @brief The Ray struct represents a scan ray with start point, end point, angle and range.
@@ -133,22 +140,52 @@ public:
     using ConstPtr         = std::shared_ptr<const Laserscan2<T>>;
     using rays_t           = std::vector<Ray, typename Ray::allocator_t>;
     using const_iterator_t = typename rays_t::const_iterator;
+    using offsets_t        = std::vector<std::size_t>;
+    using intensities_t    = std::vector<T>;
+
+    /**
+     * @brief The EchoRange struct refers to the echoes of a single beam.
+     */
+    struct EchoRange {
+        const_iterator_t first;
+        const_iterator_t last;
+
+        inline const_iterator_t begin() const
+        {
+            return first;
+        }
+
+        inline const_iterator_t end() const
+        {
+            return last;
+        }
+
+        inline std::size_t size() const
+        {
+            return static_cast<std::size_t>(std::distance(first, last));
+        }
 
-    Laserscan2(const std::string          &frame,
+        inline bool empty() const
+        {
+            return first == last;
+        }
+    };
+
+    Laserscan2(const frame_id_t           &frame,
               const time_frame_t       &time_frame,
               const cslibs_time::Time  &time_received) :
-        Data(frame, time_frame, time_received),
+        Data(staticType(), frame, time_frame, time_received),
         linear_interval_{0.0, std::numeric_limits<T>::max()},
         angular_interval_{-M_PI, M_PI}
     {
     }
 
-    Laserscan2(const std::string        &frame,
+    Laserscan2(const frame_id_t         &frame,
               const time_frame_t       &time_frame,
               const interval_t         &linear_interval,
               const interval_t         &angular_interval,
               const cslibs_time::Time  &time_received) :
-        Data(frame, time_frame, time_received),
+        Data(staticType(), frame, time_frame, time_received),
         linear_interval_(linear_interval),
         angular_interval_(angular_interval)
     {
@@ -219,11 +256,21 @@ public:
         rays_.emplace_back(Ray(angle, range, end_point, start_point));
     }
 
+    inline void insert(const Ray &ray)
+    {
+        rays_.emplace_back(ray);
+    }
+
     inline void insertInvalid()
     {
         rays_.emplace_back(Ray());
     }
 
+    inline void reserve(const std::size_t size)
+    {
+        rays_.reserve(size);
+    }
+
     inline const_iterator_t begin() const
     {
         return rays_.begin();
@@ -239,8 +286,155 @@ public:
         return rays_;
     }
 
+    /**
+     * @brief Reserve memory for intensities, which are only stored if inserted.
+     * @param size          - expected number of rays
+     */
+    inline void reserveIntensities(const std::size_t size)
+    {
+        intensities_.reserve(size);
+    }
+
+    /**
+     * @brief Append the intensity of the last inserted ray, if used it has to be
+     *        called for every ray, including invalid ones.
+     */
+    inline void insertIntensity(const T intensity)
+    {
+        intensities_.emplace_back(intensity);
+    }
+
+    /**
+     * @brief Check whether intensities are stored.
+     */
+    inline bool hasIntensities() const
+    {
+        return !intensities_.empty();
+    }
+
+    /**
+     * @brief Intensities aligned with getRays(), empty if not stored.
+     */
+    inline const intensities_t& getIntensities() const
+    {
+        return intensities_;
+    }
+
+    /**
+     * @brief Reserve memory for multi echo storage.
+     * @param beams         - expected number of beams
+     * @param echoes        - expected number of echoes over all beams
+     */
+    inline void reserveEchoes(const std::size_t beams,
+                              const std::size_t echoes)
+    {
+        echoes_.reserve(echoes);
+        echo_offsets_.reserve(beams + 1);
+    }
+
+    /**
+     * @brief Reserve memory for intensities of the echoes.
+     * @param echoes        - expected number of echoes over all beams
+     */
+    inline void reserveEchoIntensities(const std::size_t echoes)
+    {
+        echo_intensities_.reserve(echoes);
+    }
+
+    /**
+     * @brief Append an echo to the beam currently being filled,
+     *        beams are closed by closeBeam().
+     */
+    inline void insertEcho(const T       angle,
+                           const T       range,
+                           const point_t &end_point,
+                           const point_t &start_point = point_t())
+    {
+        echoes_.emplace_back(Ray(angle, range, end_point, start_point));
+    }
+
+    /**
+     * @brief Close the beam currently being filled, beams without echoes are allowed.
+     */
+    inline void closeBeam()
+    {
+        if (echo_offsets_.empty())
+            echo_offsets_.emplace_back(0ul);
+        echo_offsets_.emplace_back(echoes_.size());
+    }
+
+    /**
+     * @brief Check whether multiple echoes per beam are stored.
+     */
+    inline bool hasEchoes() const
+    {
+        return !echo_offsets_.empty();
+    }
+
+    /**
+     * @brief Number of beams in the multi echo storage.
+     */
+    inline std::size_t getBeamCount() const
+    {
+        return echo_offsets_.empty() ? 0ul : echo_offsets_.size() - 1ul;
+    }
+
+    /**
+     * @brief All valid echoes of a beam, ordered as received.
+     * @param beam          - the beam index, must be smaller than getBeamCount()
+     */
+    inline EchoRange getEchoes(const std::size_t beam) const
+    {
+        return EchoRange{echoes_.begin() + static_cast<std::ptrdiff_t>(echo_offsets_[beam]),
+                         echoes_.begin() + static_cast<std::ptrdiff_t>(echo_offsets_[beam + 1])};
+    }
+
+    /**
+     * @brief The contiguous echoes of all beams, beam i occupies
+     *        [offsets[i], offsets[i + 1]).
+     */
+    inline const rays_t& getAllEchoes() const
+    {
+        return echoes_;
+    }
+
+    inline const offsets_t& getEchoOffsets() const
+    {
+        return echo_offsets_;
+    }
+
+    /**
+     * @brief Append the intensity of the last inserted echo, if used it has to
+     *        be called for every echo.
+     */
+    inline void insertEchoIntensity(const T intensity)
+    {
+        echo_intensities_.emplace_back(intensity);
+    }
+
+    /**
+     * @brief Check whether intensities of the echoes are stored.
+     */
+    inline bool hasEchoIntensities() const
+    {
+        return !echo_intensities_.empty();
+    }
+
+    /**
+     * @brief Intensities aligned with getAllEchoes(), so beam i's are
+     *        [offsets[i], offsets[i + 1]) as well, empty if not stored.
+     */
+    inline const intensities_t& getAllEchoIntensities() const
+    {
+        return echo_intensities_;
+    }
+
 private:
     rays_t     rays_;         /// only valid rays shall be contained here
+    intensities_t intensities_; /// intensity of rays_[i], empty if not stored
+    rays_t     echoes_;       /// echoes of all beams, empty for single echo scans
+    offsets_t  echo_offsets_; /// beam i's echoes are [echo_offsets_[i], echo_offsets_[i + 1])
+    intensities_t echo_intensities_; /// intensity of echoes_[i], empty if not stored
     interval_t linear_interval_;
     interval_t angular_interval_;
 };
@@ -2,6 +2,7 @@
 #define CSLIBS_PLUGINS_DATA_TYPES_LASERSCAN_CONVERT_HPP
 
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MultiEchoLaserScan.h>
 
 #include <cslibs_math_3d/linear/pointcloud.hpp>
 #include <cslibs_plugins_data/types/laserscan.hpp>
@@ -12,8 +13,8 @@ namespace types {
 template <typename T>
 using interval_t = std::array<T, 2>;
 
-template <typename T>
-inline typename Laserscan2<T>::Ptr create(const sensor_msgs::LaserScanConstPtr &src,
+template <typename T, typename M>
+inline typename Laserscan2<T>::Ptr create(const boost::shared_ptr<const M>      &src,
                                          const std::string                     &frame_id,
                                          const interval_t<T>                   &linear_interval,
                                          const interval_t<T>                   &angular_interval,
@@ -46,11 +47,40 @@ inline typename Laserscan2<T>::Ptr create(const sensor_msgs::LaserScanConstPtr &
                                                                                      ros::Time::now().toNSec()))));
 }
 
+namespace detail {
+/**
+ * @brief Intensities to copy during conversion, null if not requested or not
+ *        available for every beam.
+ */
+inline const float* intensities(const sensor_msgs::LaserScanConstPtr &src,
+                                const bool                            with_intensities)
+{
+    return with_intensities && src->intensities.size() == src->ranges.size() && !src->ranges.empty() ?
+                src->intensities.data() : nullptr;
+}
+
+/**
+ * @brief Intensities of all echoes in the same layout as the ranges, null if not
+ *        requested or not available for every echo.
+ */
+inline const std::vector<sensor_msgs::LaserEcho>* intensities(const sensor_msgs::MultiEchoLaserScanConstPtr &src,
+                                                              const bool                                     with_intensities)
+{
+    if (!with_intensities || src->intensities.size() != src->ranges.size())
+        return nullptr;
+    for (std::size_t i = 0 ; i < src->ranges.size() ; ++i)
+        if (src->intensities[i].echoes.size() != src->ranges[i].echoes.size())
+            return nullptr;
+    return &src->intensities;
+}
+}
+
 template <typename T>
 inline bool convert(const sensor_msgs::LaserScanConstPtr &src,
                     const interval_t<T>                  &range_limits,
                     typename Laserscan2<T>::Ptr          &dst,
-                    const bool                            enforce_stamp)
+                    const bool                            enforce_stamp,
+                    const bool                            with_intensities = false)
 {
     const auto src_linear_min  = std::max(static_cast<T>(src->range_min), range_limits[0]);
     const auto src_linear_max  = std::min(static_cast<T>(src->range_max), range_limits[1]);
@@ -73,26 +103,43 @@ inline bool convert(const sensor_msgs::LaserScanConstPtr &src,
         return angle >= dst_angular_interval[0] && angle <= dst_angular_interval[1];
     };
 
+    const float *src_intensity = detail::intensities(src, with_intensities);
+    if (src_intensity)
+        dst->reserveIntensities(src_ranges.size());
+
     auto angle = src_angular_min;
     for (const auto range : src_ranges) {
         if(in_linear_interval(range) && in_angular_interval(angle))
             dst->insert(static_cast<T>(angle), static_cast<T>(range));
         else
             dst->insertInvalid();
+        if (src_intensity)
+            dst->insertIntensity(static_cast<T>(*src_intensity++));
 
         angle += src_angle_increment;
     }
     return true;
 }
 
+/**
+ * @brief Convert a laser scan into a target frame with a transform looked up beforehand,
+ *        so that waiting for the transform can be accounted separately.
+ * @param src               - the laser scan message
+ * @param t_T_l             - transform from the laser frame into the target frame
+ * @param tf_target_frame   - the target frame
+ * @param range_limits      - range limits in the laser frame
+ * @param dst               - the converted laser scan
+ * @param enforce_stamp     - use the header stamp as start and end of the time frame
+ * @param with_intensities  - store intensities aligned with the rays, if the scan has them
+ */
 template <typename T>
 inline bool convert(const sensor_msgs::LaserScanConstPtr  &src,
-                    cslibs_math_ros::tf::TFProvider::Ptr  &tf_listener,
+                    const cslibs_math_3d::Transform3<T>   &t_T_l,
                     const std::string                     &tf_target_frame,
-                    const ros::Duration                   &tf_timeout,
                     const interval_t<T>                   &range_limits,
                     typename Laserscan2<T>::Ptr            &dst,
-                    const bool                             enforce_stamp)
+                    const bool                             enforce_stamp,
+                    const bool                             with_intensities = false)
 {
     const auto src_linear_min  = std::max(static_cast<T>(src->range_min), range_limits[0]);
     const auto src_linear_max  = std::min(static_cast<T>(src->range_max), range_limits[1]);
@@ -115,53 +162,60 @@ inline bool convert(const sensor_msgs::LaserScanConstPtr  &src,
         return angle >= dst_angular_interval[0] && angle <= dst_angular_interval[1];
     };
 
-    cslibs_math_3d::Transform3<T> t_T_l;
-    if(tf_listener->lookupTransform(tf_target_frame, src->header.frame_id, src->header.stamp, t_T_l, tf_timeout)) {
-        const cslibs_math_2d::Point2<T> start_point(t_T_l.tx(), t_T_l.ty());
-        auto angle = src_angular_min;
-        for (const auto range : src_ranges) {
-            if(in_linear_interval(range) && in_angular_interval(angle)) {
-                const cslibs_math_3d::Point3<T> p =
-                        t_T_l * cslibs_math_3d::Point3<T>(std::cos(static_cast<T>(angle)) * static_cast<T>(range),
-                                                          std::sin(static_cast<T>(angle)) * static_cast<T>(range),
-                                                          T());
-                const cslibs_math_2d::Point2<T> end_point(p(0), p(1));
-
-                const T transformed_angle = cslibs_math_2d::angle(end_point - start_point);
-                const T range = cslibs_math::linear::distance(start_point, end_point);
-
-                dst->insert(transformed_angle, range, end_point, start_point);
-            } else {
-                dst->insertInvalid();
-            }
+    const float *src_intensity = detail::intensities(src, with_intensities);
+    if (src_intensity)
+        dst->reserveIntensities(src_ranges.size());
 
-            angle += src_angle_increment;
+    const cslibs_math_2d::Point2<T> start_point(t_T_l.tx(), t_T_l.ty());
+    auto angle = src_angular_min;
+    for (const auto range : src_ranges) {
+        if(in_linear_interval(range) && in_angular_interval(angle)) {
+            const cslibs_math_3d::Point3<T> p =
+                    t_T_l * cslibs_math_3d::Point3<T>(std::cos(static_cast<T>(angle)) * static_cast<T>(range),
+                                                      std::sin(static_cast<T>(angle)) * static_cast<T>(range),
+                                                      T());
+            const cslibs_math_2d::Point2<T> end_point(p(0), p(1));
+
+            const T transformed_angle = cslibs_math_2d::angle(end_point - start_point);
+            const T range = cslibs_math::linear::distance(start_point, end_point);
+
+            dst->insert(transformed_angle, range, end_point, start_point);
+        } else {
+            dst->insertInvalid();
         }
-        return true;
+        if (src_intensity)
+            dst->insertIntensity(static_cast<T>(*src_intensity++));
+
+        angle += src_angle_increment;
     }
-    return false;
+    return true;
 }
 
+namespace detail {
 template <typename T>
-inline bool convertUndistorted(const sensor_msgs::LaserScanConstPtr  &src,
-                               cslibs_math_ros::tf::TFProvider::Ptr  &tf_listener,
-                               const std::string                     &fixed_frame,
-                               const ros::Duration                   &tf_timeout,
-                               typename Laserscan2<T>::Ptr            &dst)
+inline bool convertEchoes(const sensor_msgs::MultiEchoLaserScanConstPtr &src,
+                          const cslibs_math_3d::Transform3<T>           *t_T_l,
+                          const std::string                             &frame_id,
+                          const interval_t<T>                           &range_limits,
+                          typename Laserscan2<T>::Ptr                    &dst,
+                          const bool                                     enforce_stamp,
+                          const bool                                     with_intensities)
 {
-    const auto src_linear_min  = static_cast<T>(src->range_min);
-    const auto src_linear_max  = static_cast<T>(src->range_max);
+    using point_t = typename Laserscan2<T>::point_t;
+
+    const auto src_linear_min  = std::max(static_cast<T>(src->range_min), range_limits[0]);
+    const auto src_linear_max  = std::min(static_cast<T>(src->range_max), range_limits[1]);
     const auto src_angular_min = static_cast<T>(src->angle_min);
     const auto src_angular_max = static_cast<T>(src->angle_max);
-    const auto &src_ranges         = src->ranges;
+    const auto &src_beams          = src->ranges;
     const auto src_angle_increment = src->angle_increment;
 
-    if (src_ranges.size() == 0ul)
+    if (src_beams.size() == 0ul)
         return false;
 
     const interval_t<T> dst_linear_interval  = { src_linear_min,  src_linear_max };
     const interval_t<T> dst_angular_interval = { src_angular_min, src_angular_max };
-    dst = create(src, src->header.frame_id, dst_linear_interval, dst_angular_interval);
+    dst = create<T>(src, frame_id, dst_linear_interval, dst_angular_interval, enforce_stamp);
 
     auto in_linear_interval = [&dst_linear_interval](const T range) {
         return range > dst_linear_interval[0] && range < dst_linear_interval[1];
@@ -170,6 +224,150 @@ inline bool convertUndistorted(const sensor_msgs::LaserScanConstPtr  &src,
         return angle >= dst_angular_interval[0] && angle <= dst_angular_interval[1];
     };
 
+    std::size_t echoes = 0ul;
+    for (const auto &beam : src_beams)
+        echoes += beam.echoes.size();
+    dst->reserveEchoes(src_beams.size(), echoes);
+
+    const auto *src_intensities = intensities(src, with_intensities);
+    if (src_intensities) {
+        dst->reserveIntensities(src_beams.size());
+        dst->reserveEchoIntensities(echoes);
+    }
+
+    const point_t start_point = t_T_l ? point_t(t_T_l->tx(), t_T_l->ty()) : point_t();
+    auto angle = src_angular_min;
+    for (std::size_t b = 0 ; b < src_beams.size() ; ++b) {
+        const auto &beam = src_beams[b];
+        bool primary = false;
+        T primary_intensity = T();
+        if (in_angular_interval(angle)) {
+            const T cos_angle = std::cos(static_cast<T>(angle));
+            const T sin_angle = std::sin(static_cast<T>(angle));
+            for (std::size_t e = 0 ; e < beam.echoes.size() ; ++e) {
+                const auto echo = beam.echoes[e];
+                if (!in_linear_interval(echo))
+                    continue;
+
+                T range = static_cast<T>(echo);
+                T echo_angle = static_cast<T>(angle);
+                point_t end_point(cos_angle * range, sin_angle * range);
+                if (t_T_l) {
+                    const cslibs_math_3d::Point3<T> p = (*t_T_l) * cslibs_math_3d::Point3<T>(end_point(0), end_point(1), T());
+                    end_point  = point_t(p(0), p(1));
+                    echo_angle = cslibs_math_2d::angle(end_point - start_point);
+                    range      = cslibs_math::linear::distance(start_point, end_point);
+                }
+
+                const T intensity = src_intensities ? static_cast<T>((*src_intensities)[b].echoes[e]) : T();
+                dst->insertEcho(echo_angle, range, end_point, start_point);
+                if (src_intensities)
+                    dst->insertEchoIntensity(intensity);
+                if (!primary) {
+                    dst->insert(echo_angle, range, end_point, start_point);
+                    primary_intensity = intensity;
+                    primary = true;
+                }
+            }
+        }
+        if (!primary)
+            dst->insertInvalid();
+        if (src_intensities)
+            dst->insertIntensity(primary_intensity);
+        dst->closeBeam();
+
+        angle += src_angle_increment;
+    }
+    return true;
+}
+}
+
+/**
+ * @brief Convert a multi echo laser scan in a single pass. All valid echoes are
+ *        stored per beam, the first valid echo of each beam is also inserted as
+ *        the beam's ray, so single echo consumers can process the scan as is.
+ * @param src               - the multi echo laser scan message
+ * @param range_limits      - range limits in the laser frame
+ * @param dst               - the converted laser scan
+ * @param enforce_stamp     - use the header stamp as start and end of the time frame
+ * @param with_intensities  - store the intensity of each beam's ray and of every
+ *                            echo, if the scan has them
+ */
+template <typename T>
+inline bool convert(const sensor_msgs::MultiEchoLaserScanConstPtr &src,
+                    const interval_t<T>                           &range_limits,
+                    typename Laserscan2<T>::Ptr                    &dst,
+                    const bool                                     enforce_stamp,
+                    const bool                                     with_intensities = false)
+{
+    return detail::convertEchoes<T>(src, nullptr, src->header.frame_id, range_limits, dst, enforce_stamp, with_intensities);
+}
+
+/**
+ * @brief Convert a multi echo laser scan into a target frame in a single pass.
+ * @param src               - the multi echo laser scan message
+ * @param t_T_l             - transform from the laser frame into the target frame
+ * @param tf_target_frame   - the target frame
+ * @param range_limits      - range limits in the laser frame
+ * @param dst               - the converted laser scan
+ * @param enforce_stamp     - use the header stamp as start and end of the time frame
+ * @param with_intensities  - store the intensity of each beam's ray and of every
+ *                            echo, if the scan has them
+ */
+template <typename T>
+inline bool convert(const sensor_msgs::MultiEchoLaserScanConstPtr &src,
+                    const cslibs_math_3d::Transform3<T>           &t_T_l,
+                    const std::string                             &tf_target_frame,
+                    const interval_t<T>                           &range_limits,
+                    typename Laserscan2<T>::Ptr                    &dst,
+                    const bool                                     enforce_stamp,
+                    const bool                                     with_intensities = false)
+{
+    return detail::convertEchoes<T>(src, &t_T_l, tf_target_frame, range_limits, dst, enforce_stamp, with_intensities);
+}
+
+template <typename T>
+inline bool convert(const sensor_msgs::LaserScanConstPtr  &src,
+                    cslibs_math_ros::tf::TFProvider::Ptr  &tf_listener,
+                    const std::string                     &tf_target_frame,
+                    const ros::Duration                   &tf_timeout,
+                    const interval_t<T>                   &range_limits,
+                    typename Laserscan2<T>::Ptr            &dst,
+                    const bool                             enforce_stamp,
+                    const bool                             with_intensities = false)
+{
+    if (src->ranges.size() == 0ul)
+        return false;
+
+    cslibs_math_3d::Transform3<T> t_T_l;
+    if (!tf_listener->lookupTransform(tf_target_frame, src->header.frame_id, src->header.stamp, t_T_l, tf_timeout))
+        return false;
+    return convert(src, t_T_l, tf_target_frame, range_limits, dst, enforce_stamp, with_intensities);
+}
+
+/**
+ * @brief Convert a scan and compensate the motion of its frame relative to the
+ *        fixed frame while the scan was taken. The transforms at start and end
+ *        of the scan are checked before anything is allocated, so with a zero
+ *        tf_timeout the call never blocks and can be retried later on failure.
+ */
+template <typename T>
+inline bool convertUndistorted(const sensor_msgs::LaserScanConstPtr  &src,
+                               cslibs_math_ros::tf::TFProvider::Ptr  &tf_listener,
+                               const std::string                     &fixed_frame,
+                               const ros::Duration                   &tf_timeout,
+                               typename Laserscan2<T>::Ptr            &dst)
+{
+    const auto src_linear_min  = static_cast<T>(src->range_min);
+    const auto src_linear_max  = static_cast<T>(src->range_max);
+    const auto src_angular_min = static_cast<T>(src->angle_min);
+    const auto src_angular_max = static_cast<T>(src->angle_max);
+    const auto &src_ranges         = src->ranges;
+    const auto src_angle_increment = src->angle_increment;
+
+    if (src_ranges.size() == 0ul)
+        return false;
+
     const ros::Time start_stamp = src->header.stamp;
     ros::Duration   delta_stamp = ros::Duration(src->time_increment);
     if (delta_stamp <= ros::Duration(0.0))
@@ -179,13 +377,24 @@ inline bool convertUndistorted(const sensor_msgs::LaserScanConstPtr  &src,
 
 
     cslibs_math_2d::Transform2<T> cs_start_T_end;
-    if (!tf_listener->lookupTransform(fixed_frame, dst->frame(), end_stamp, cs_start_T_end, tf_timeout))
+    if (!tf_listener->lookupTransform(fixed_frame, src->header.frame_id, end_stamp, cs_start_T_end, tf_timeout))
         return false;
     tf::Transform start_T_end = cslibs_math_ros::tf::conversion_2d::from(cs_start_T_end);
 
-    if (!tf_listener->waitForTransform(fixed_frame, dst->frame(), start_stamp, tf_timeout))
+    if (!tf_listener->waitForTransform(fixed_frame, src->header.frame_id, start_stamp, tf_timeout))
         return false;
 
+    const interval_t<T> dst_linear_interval  = { src_linear_min,  src_linear_max };
+    const interval_t<T> dst_angular_interval = { src_angular_min, src_angular_max };
+    dst = create(src, src->header.frame_id, dst_linear_interval, dst_angular_interval);
+
+    auto in_linear_interval = [&dst_linear_interval](const T range) {
+        return range > dst_linear_interval[0] && range < dst_linear_interval[1];
+    };
+    auto in_angular_interval = [&dst_angular_interval](const T angle) {
+        return angle >= dst_angular_interval[0] && angle <= dst_angular_interval[1];
+    };
+
     tf::Transform end_T_start = start_T_end.inverse();
 
     auto angle = src_angular_min;
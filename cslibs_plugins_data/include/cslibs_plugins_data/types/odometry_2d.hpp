@@ -20,9 +20,15 @@ public:
     using time_t       = cslibs_time::Time;
     using transform_t  = cslibs_math_2d::Transform2<T>;
     using vector_t     = cslibs_math_2d::Vector2<T>;
+    using tagged_t     = Odometry2<T>;
 
-    Odometry2(const std::string &frame) :
-      Data(frame),
+    inline static constexpr DataType staticType()
+    {
+        return std::is_same<T, double>::value ? DataType::ODOMETRY2D : DataType::ODOMETRY2F;
+    }
+
+    Odometry2(const frame_id_t &frame) :
+      Data(staticType(), frame),
       start_pose_(transform_t::identity()),
       end_pose_(transform_t::identity()),
       delta_linear_(0.0),
@@ -31,10 +37,10 @@ public:
     {
     }
 
-    Odometry2(const std::string  &frame,
+    Odometry2(const frame_id_t   &frame,
               const time_frame_t &time_frame,
               const time_t       &time_received) :
-      Data(frame, time_frame, time_received),
+      Data(staticType(), frame, time_frame, time_received),
       start_pose_(transform_t::identity()),
       end_pose_(transform_t::identity()),
       delta_linear_(0.0),
@@ -43,12 +49,12 @@ public:
     {
     }
 
-    Odometry2(const std::string  &frame,
+    Odometry2(const frame_id_t   &frame,
               const time_frame_t &time_frame,
               const transform_t  &start,
               const transform_t  &end,
               const time_t       &time_received) :
-      Data(frame, time_frame, time_received),
+      Data(staticType(), frame, time_frame, time_received),
       start_pose_(start),
       end_pose_(end),
       delta_lin_abs_(end.translation() - start.translation()),
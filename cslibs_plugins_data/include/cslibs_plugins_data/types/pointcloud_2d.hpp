@@ -14,16 +14,22 @@ class Pointcloud2 : public Data
 public:
     using Ptr     = std::shared_ptr<Pointcloud2<T>>;
     using cloud_t = cslibs_math_2d::Pointcloud2<T>;
+    using tagged_t = Pointcloud2<T>;
 
-    Pointcloud2(const std::string &frame_id) :
-        Data(frame_id)
+    inline static constexpr DataType staticType()
     {
+        return std::is_same<T, double>::value ? DataType::POINTCLOUD2D : DataType::POINTCLOUD2F;
     }
 
-    Pointcloud2(const std::string      &frame,
+    Pointcloud2(const frame_id_t &frame_id) :
+        Data(staticType(), frame_id)
+    {
+    }
+
+    Pointcloud2(const frame_id_t       &frame,
                 const cslibs_time::TimeFrame   &time_frame,
                 const cslibs_time::Time        &time_received) :
-        Data(frame, time_frame, time_received)
+        Data(staticType(), frame, time_frame, time_received)
     {
     }
 
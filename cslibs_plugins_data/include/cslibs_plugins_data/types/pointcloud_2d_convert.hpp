@@ -0,0 +1,71 @@
+#ifndef CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_2D_CONVERT_HPP
+#define CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_2D_CONVERT_HPP
+
+#include <cslibs_math_2d/linear/pointcloud.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_convert.hpp>
+
+#include <array>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace types {
+/**
+ * @brief Project all points of a point cloud message lying within a height band
+ *        onto the ground plane of the target frame. Range limits refer to the
+ *        sensor frame, the height band to the target frame.
+ * @param view          - the view onto the message
+ * @param transform     - the transform from the message frame into the target frame
+ * @param height_band   - minimum and maximum height in the target frame
+ * @param workers       - pool to distribute the projection on, may be null
+ * @param dst           - the projected 2D point cloud
+ * @param min_chunk_size- minimum amount of points per chunk
+ */
+template <typename T>
+inline void slice(const Pointcloud3View<T>                        &view,
+                  const cslibs_math_3d::Transform3<T>             &transform,
+                  const std::array<T, 2>                          &height_band,
+                  common::WorkerPool                              *workers,
+                  typename cslibs_math_2d::Pointcloud2<T>::Ptr    &dst,
+                  const std::size_t                                min_chunk_size = 4096)
+{
+    using point_t = cslibs_math_2d::Point2<T>;
+
+    dst.reset(new cslibs_math_2d::Pointcloud2<T>);
+    const std::size_t n = view.size();
+    if (n == 0)
+        return;
+
+    const detail::affine_t<T> m = detail::toAffine(transform);
+
+    const std::size_t threads = workers ? workers->size() + 1 : 1ul;
+    const std::size_t chunks  = std::max<std::size_t>(1ul, std::min(threads, n / std::max<std::size_t>(min_chunk_size, 1ul)));
+    const std::size_t chunk   = (n + chunks - 1) / chunks;
+
+    std::vector<detail::ChunkBuffer<T>> buffers(chunks);
+    auto work = [&](const std::size_t c) {
+        detail::ChunkBuffer<T> &b = buffers[c];
+        detail::convertChunk<T>(view, &m, c * chunk, std::min(n, (c + 1) * chunk), b, nullptr);
+
+        const T z_min = height_band[0];
+        const T z_max = height_band[1];
+        const std::size_t size = b.valid.size();
+        for (std::size_t i = 0 ; i < size ; ++i)
+            b.valid[i] &= b.z[i] >= z_min && b.z[i] <= z_max;
+    };
+    if (workers && chunks > 1)
+        workers->parallelFor(chunks, work);
+    else
+        for (std::size_t c = 0 ; c < chunks ; ++c)
+            work(c);
+
+    for (const auto &b : buffers) {
+        for (std::size_t i = 0 ; i < b.valid.size() ; ++i) {
+            if (b.valid[i])
+                dst->insert(point_t(b.x[i], b.y[i]));
+        }
+    }
+}
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_2D_CONVERT_HPP
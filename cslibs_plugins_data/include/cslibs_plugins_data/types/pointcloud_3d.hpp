@@ -5,6 +5,8 @@
 
 #include <cslibs_math_3d/linear/pointcloud.hpp>
 #include <cslibs_math_ros/sensor_msgs/conversion_3d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_view.hpp>
+#include <cslibs_plugins_data/types/range_image_3d.hpp>
 
 namespace cslibs_plugins_data {
 namespace types {
@@ -12,23 +14,38 @@ template <typename T>
 class Pointcloud3 : public Data
 {
 public:
-    using Ptr     = std::shared_ptr<Pointcloud3<T>>;
-    using cloud_t = cslibs_math_3d::Pointcloud3<T>;
+    using Ptr      = std::shared_ptr<Pointcloud3<T>>;
+    using ConstPtr = std::shared_ptr<const Pointcloud3<T>>;
+    using cloud_t  = cslibs_math_3d::Pointcloud3<T>;
+    using view_t   = Pointcloud3View<T>;
+    using image_t  = RangeImage3<T>;
+    using tagged_t = Pointcloud3<T>;
 
-    Pointcloud3(const std::string &frame_id) :
-        Data(frame_id)
+    inline static constexpr DataType staticType()
     {
+        return std::is_same<T, double>::value ? DataType::POINTCLOUD3D : DataType::POINTCLOUD3F;
     }
 
-    Pointcloud3(const std::string      &frame,
+    Pointcloud3(const frame_id_t &frame_id) :
+        Data(staticType(), frame_id)
+    {
+    }
+
+    Pointcloud3(const frame_id_t       &frame,
          const cslibs_time::TimeFrame   &time_frame,
          const cslibs_time::Time        &time_received) :
-        Data(frame, time_frame, time_received)
+        Data(staticType(), frame, time_frame, time_received)
     {
     }
 
+    /**
+     * @brief Get the converted points. If the point cloud was created as a view
+     *        onto the received message, the points are converted on first access.
+     */
     inline const typename cloud_t::ConstPtr points() const
     {
+        if (!points_ && view_)
+            return view_->points();
         return points_;
     }
 
@@ -37,8 +54,48 @@ public:
         return points_;
     }
 
+    /**
+     * @brief Zero-copy access to the received message, only set if the provider
+     *        was configured to skip conversion.
+     */
+    inline const typename view_t::ConstPtr& view() const
+    {
+        return view_;
+    }
+
+    inline bool hasView() const
+    {
+        return static_cast<bool>(view_);
+    }
+
+    inline void setView(const typename view_t::ConstPtr &view)
+    {
+        view_ = view;
+    }
+
+    /**
+     * @brief Organized layout of the scan, only set for organized input clouds
+     *        if the provider was configured to keep it.
+     */
+    inline const typename image_t::ConstPtr rangeImage() const
+    {
+        return range_image_;
+    }
+
+    inline typename image_t::Ptr& rangeImage()
+    {
+        return range_image_;
+    }
+
+    inline bool isOrganized() const
+    {
+        return static_cast<bool>(range_image_);
+    }
+
 private:
-    typename cloud_t::Ptr points_;
+    typename cloud_t::Ptr       points_;
+    typename view_t::ConstPtr   view_;
+    typename image_t::Ptr       range_image_;
 };
 using Pointcloud3d = Pointcloud3<double>;
 using Pointcloud3f = Pointcloud3<float>;
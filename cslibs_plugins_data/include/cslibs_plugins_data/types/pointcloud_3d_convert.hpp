@@ -0,0 +1,195 @@
+#ifndef CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_CONVERT_HPP
+#define CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_CONVERT_HPP
+
+#include <cslibs_math_3d/linear/transform.hpp>
+#include <cslibs_plugins_data/common/finite.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_view.hpp>
+#include <cslibs_plugins_data/types/range_image_3d.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace types {
+namespace detail {
+/// row major 3x4 matrix [R | t]
+template <typename T>
+using affine_t = std::array<T, 12>;
+
+template <typename T>
+inline affine_t<T> toAffine(const cslibs_math_3d::Transform3<T> &t)
+{
+    using point_t = cslibs_math_3d::Point3<T>;
+    const point_t o  = t * point_t(0, 0, 0);
+    const point_t ex = t * point_t(1, 0, 0);
+    const point_t ey = t * point_t(0, 1, 0);
+    const point_t ez = t * point_t(0, 0, 1);
+    return {ex(0) - o(0), ey(0) - o(0), ez(0) - o(0), o(0),
+            ex(1) - o(1), ey(1) - o(1), ez(1) - o(1), o(1),
+            ex(2) - o(2), ey(2) - o(2), ez(2) - o(2), o(2)};
+}
+
+/**
+ * @brief Chunk buffer in structure of arrays layout, so that range filtering
+ *        and transformation compile to branch free loops.
+ */
+template <typename T>
+struct ChunkBuffer {
+    std::vector<T>       x;
+    std::vector<T>       y;
+    std::vector<T>       z;
+    std::vector<T>       r_sq;
+    std::vector<uint8_t> valid;
+
+    inline void resize(const std::size_t n)
+    {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        r_sq.resize(n);
+        valid.resize(n);
+    }
+};
+
+template <typename T>
+inline void convertChunk(const Pointcloud3View<T> &view,
+                         const affine_t<T>        *transform,
+                         const std::size_t         begin,
+                         const std::size_t         end,
+                         ChunkBuffer<T>           &buffer,
+                         RangeImage3<T>           *image)
+{
+    const std::size_t n = end - begin;
+    buffer.resize(n);
+    T       *x     = buffer.x.data();
+    T       *y     = buffer.y.data();
+    T       *z     = buffer.z.data();
+    T       *r_sq  = buffer.r_sq.data();
+    uint8_t *valid = buffer.valid.data();
+
+    for (std::size_t i = 0 ; i < n ; ++i) {
+        x[i] = view.x(begin + i);
+        y[i] = view.y(begin + i);
+        z[i] = view.z(begin + i);
+    }
+
+    /// range limits refer to the sensor frame
+    const T min_sq = view.rangeLimits()[0] * view.rangeLimits()[0];
+    const T max    = view.rangeLimits()[1];
+    const T max_sq = max < std::sqrt(std::numeric_limits<T>::max()) ? max * max : std::numeric_limits<T>::max();
+    for (std::size_t i = 0 ; i < n ; ++i) {
+        r_sq[i]  = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        valid[i] = common::isFinite(r_sq[i]) && r_sq[i] >= min_sq && r_sq[i] <= max_sq;
+    }
+
+    if (transform) {
+        const affine_t<T> &m = *transform;
+        for (std::size_t i = 0 ; i < n ; ++i) {
+            const T px = x[i];
+            const T py = y[i];
+            const T pz = z[i];
+            x[i] = m[0] * px + m[1] * py + m[2]  * pz + m[3];
+            y[i] = m[4] * px + m[5] * py + m[6]  * pz + m[7];
+            z[i] = m[8] * px + m[9] * py + m[10] * pz + m[11];
+        }
+    }
+
+    /// the image shares the row major layout of the message
+    if (image) {
+        for (std::size_t i = 0 ; i < n ; ++i) {
+            if (valid[i])
+                image->set(begin + i, x[i], y[i], z[i], std::sqrt(r_sq[i]));
+            else
+                image->setInvalid(begin + i);
+        }
+    }
+}
+
+template <typename T>
+inline void convert(const Pointcloud3View<T>                         &view,
+                    const affine_t<T>                                *transform,
+                    common::WorkerPool                               *workers,
+                    const std::size_t                                 min_chunk_size,
+                    typename cslibs_math_3d::Pointcloud3<T>::Ptr     &dst,
+                    typename RangeImage3<T>::Ptr                     *image)
+{
+    using point_t = cslibs_math_3d::Point3<T>;
+
+    dst.reset(new cslibs_math_3d::Pointcloud3<T>);
+    const std::size_t n = view.size();
+    if (image)
+        image->reset(new RangeImage3<T>(view.height(), view.width()));
+    if (n == 0)
+        return;
+
+    const std::size_t threads = workers ? workers->size() + 1 : 1ul;
+    const std::size_t chunks  = std::max<std::size_t>(1ul, std::min(threads, n / std::max<std::size_t>(min_chunk_size, 1ul)));
+    const std::size_t chunk   = (n + chunks - 1) / chunks;
+
+    std::vector<ChunkBuffer<T>> buffers(chunks);
+    auto work = [&](const std::size_t c) {
+        convertChunk(view, transform, c * chunk, std::min(n, (c + 1) * chunk), buffers[c],
+                     image ? image->get() : nullptr);
+    };
+    if (workers && chunks > 1)
+        workers->parallelFor(chunks, work);
+    else
+        for (std::size_t c = 0 ; c < chunks ; ++c)
+            work(c);
+
+    /// chunks are appended in order, the output order matches the input order
+    for (const auto &b : buffers) {
+        for (std::size_t i = 0 ; i < b.valid.size() ; ++i) {
+            if (b.valid[i])
+                dst->insert(point_t(b.x[i], b.y[i], b.z[i]));
+        }
+    }
+}
+}
+
+/**
+ * @brief Convert a point cloud message, points outside the view's range limits are dropped.
+ * @param view          - the view onto the message
+ * @param workers       - pool to distribute the conversion on, may be null
+ * @param dst           - the converted point cloud
+ * @param min_chunk_size- minimum amount of points per chunk
+ * @param image         - if given, filled with the organized layout of the message
+ */
+template <typename T>
+inline void convert(const Pointcloud3View<T>                        &view,
+                    common::WorkerPool                              *workers,
+                    typename cslibs_math_3d::Pointcloud3<T>::Ptr    &dst,
+                    const std::size_t                                min_chunk_size = 4096,
+                    typename RangeImage3<T>::Ptr                    *image = nullptr)
+{
+    detail::convert<T>(view, nullptr, workers, min_chunk_size, dst, image);
+}
+
+/**
+ * @brief Convert a point cloud message and transform all points in one batch.
+ * @param view          - the view onto the message
+ * @param transform     - the transform from the message frame into the target frame
+ * @param workers       - pool to distribute the conversion on, may be null
+ * @param dst           - the converted point cloud
+ * @param min_chunk_size- minimum amount of points per chunk
+ * @param image         - if given, filled with the organized layout of the message
+ */
+template <typename T>
+inline void convert(const Pointcloud3View<T>                        &view,
+                    const cslibs_math_3d::Transform3<T>             &transform,
+                    common::WorkerPool                              *workers,
+                    typename cslibs_math_3d::Pointcloud3<T>::Ptr    &dst,
+                    const std::size_t                                min_chunk_size = 4096,
+                    typename RangeImage3<T>::Ptr                    *image = nullptr)
+{
+    const detail::affine_t<T> m = detail::toAffine(transform);
+    detail::convert<T>(view, &m, workers, min_chunk_size, dst, image);
+}
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_CONVERT_HPP
@@ -0,0 +1,301 @@
+#ifndef CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VIEW_HPP
+#define CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VIEW_HPP
+
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+
+#include <cslibs_math_3d/linear/point.hpp>
+#include <cslibs_math_3d/linear/pointcloud.hpp>
+#include <cslibs_plugins_data/common/finite.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace types {
+namespace detail {
+template <typename S> struct point_field_type;
+template <> struct point_field_type<int8_t>   { static constexpr uint8_t value = sensor_msgs::PointField::INT8;    };
+template <> struct point_field_type<uint8_t>  { static constexpr uint8_t value = sensor_msgs::PointField::UINT8;   };
+template <> struct point_field_type<int16_t>  { static constexpr uint8_t value = sensor_msgs::PointField::INT16;   };
+template <> struct point_field_type<uint16_t> { static constexpr uint8_t value = sensor_msgs::PointField::UINT16;  };
+template <> struct point_field_type<int32_t>  { static constexpr uint8_t value = sensor_msgs::PointField::INT32;   };
+template <> struct point_field_type<uint32_t> { static constexpr uint8_t value = sensor_msgs::PointField::UINT32;  };
+template <> struct point_field_type<float>    { static constexpr uint8_t value = sensor_msgs::PointField::FLOAT32; };
+template <> struct point_field_type<double>   { static constexpr uint8_t value = sensor_msgs::PointField::FLOAT64; };
+}
+
+/**
+ * @brief The StridedField class gives typed read access to a single field of a
+ *        serialized point cloud without copying the underlying buffer.
+ *        Elements are addressed in row major order, padded rows are respected.
+ */
+template <typename S>
+class StridedField
+{
+public:
+    inline StridedField() :
+        data_(nullptr),
+        point_step_(0),
+        row_step_(0),
+        width_(0),
+        size_(0)
+    {
+    }
+
+    inline StridedField(const uint8_t    *data,
+                        const std::size_t point_step,
+                        const std::size_t row_step,
+                        const std::size_t width,
+                        const std::size_t size) :
+        data_(data),
+        point_step_(point_step),
+        row_step_(row_step),
+        width_(width),
+        size_(size)
+    {
+    }
+
+    inline S operator [] (const std::size_t i) const
+    {
+        S s;
+        std::memcpy(&s, data_ + offset(i), sizeof(S));
+        return s;
+    }
+
+    inline S at(const std::size_t row,
+                const std::size_t col) const
+    {
+        S s;
+        std::memcpy(&s, data_ + row * row_step_ + col * point_step_, sizeof(S));
+        return s;
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    inline bool valid() const
+    {
+        return data_ != nullptr;
+    }
+
+private:
+    const uint8_t *data_;
+    std::size_t    point_step_;
+    std::size_t    row_step_;
+    std::size_t    width_;
+    std::size_t    size_;
+
+    inline std::size_t offset(const std::size_t i) const
+    {
+        return row_step_ == width_ * point_step_ ?
+                    i * point_step_ :
+                    (i / width_) * row_step_ + (i % width_) * point_step_;
+    }
+};
+
+/**
+ * @brief The Pointcloud3View class wraps a received point cloud message and
+ *        exposes its points without conversion. The range mask and a converted
+ *        point cloud are only computed on first request and shared afterwards.
+ *        Data is expected to be in host byte order.
+ */
+template <typename T>
+class Pointcloud3View
+{
+public:
+    using Ptr        = std::shared_ptr<Pointcloud3View<T>>;
+    using ConstPtr   = std::shared_ptr<const Pointcloud3View<T>>;
+    using msg_t      = sensor_msgs::PointCloud2ConstPtr;
+    using point_t    = cslibs_math_3d::Point3<T>;
+    using cloud_t    = cslibs_math_3d::Pointcloud3<T>;
+    using mask_t     = std::vector<uint8_t>;
+    using interval_t = std::array<T, 2>;
+
+    inline Pointcloud3View(const msg_t      &msg,
+                           const interval_t &range_limits = {0, std::numeric_limits<T>::max()}) :
+        msg_(msg),
+        range_limits_(range_limits)
+    {
+        const auto *fx = findField("x");
+        const auto *fy = findField("y");
+        const auto *fz = findField("z");
+        if (!fx || !fy || !fz)
+            throw std::runtime_error("[Pointcloud3View]: Point cloud does not provide x, y and z fields!");
+        if (fx->datatype != fy->datatype || fx->datatype != fz->datatype ||
+                (fx->datatype != sensor_msgs::PointField::FLOAT32 &&
+                 fx->datatype != sensor_msgs::PointField::FLOAT64))
+            throw std::runtime_error("[Pointcloud3View]: Fields x, y and z must share a floating point type!");
+
+        xyz_double_ = fx->datatype == sensor_msgs::PointField::FLOAT64;
+        offsets_    = {fx->offset, fy->offset, fz->offset};
+    }
+
+    inline msg_t const & message() const
+    {
+        return msg_;
+    }
+
+    inline interval_t const & rangeLimits() const
+    {
+        return range_limits_;
+    }
+
+    inline std::size_t size() const
+    {
+        return static_cast<std::size_t>(msg_->width) * static_cast<std::size_t>(msg_->height);
+    }
+
+    inline std::size_t width() const
+    {
+        return msg_->width;
+    }
+
+    inline std::size_t height() const
+    {
+        return msg_->height;
+    }
+
+    inline bool organized() const
+    {
+        return msg_->height > 1;
+    }
+
+    inline bool hasField(const std::string &name) const
+    {
+        return findField(name) != nullptr;
+    }
+
+    /**
+     * @brief Get a typed accessor for an arbitrary field, e.g. "intensity" or "ring".
+     * @param name  - name of the field
+     * @return the accessor, throws if the field is missing or of different type
+     */
+    template <typename S>
+    inline StridedField<S> field(const std::string &name) const
+    {
+        const auto *f = findField(name);
+        if (!f)
+            throw std::runtime_error("[Pointcloud3View]: Unknown field '" + name + "'!");
+        if (f->datatype != detail::point_field_type<S>::value)
+            throw std::runtime_error("[Pointcloud3View]: Field '" + name + "' has a different type!");
+        return StridedField<S>(msg_->data.data() + f->offset,
+                               msg_->point_step, msg_->row_step, msg_->width, size());
+    }
+
+    inline T x(const std::size_t i) const
+    {
+        return read(i, offsets_[0]);
+    }
+
+    inline T y(const std::size_t i) const
+    {
+        return read(i, offsets_[1]);
+    }
+
+    inline T z(const std::size_t i) const
+    {
+        return read(i, offsets_[2]);
+    }
+
+    inline point_t point(const std::size_t i) const
+    {
+        return point_t(x(i), y(i), z(i));
+    }
+
+    /**
+     * @brief Check if a point is finite and within the range limits.
+     * @param i     - index of the point
+     */
+    inline bool valid(const std::size_t i) const
+    {
+        const point_t p = point(i);
+        if (!common::isFinite(p(0)) || !common::isFinite(p(1)) || !common::isFinite(p(2)))
+            return false;
+        const T range = p.length();
+        return range >= range_limits_[0] && range <= range_limits_[1];
+    }
+
+    /**
+     * @brief Range mask with one entry per point, computed on first access.
+     */
+    inline mask_t const & mask() const
+    {
+        std::call_once(mask_once_, [this]() {
+            const std::size_t n = size();
+            mask_.resize(n);
+            for (std::size_t i = 0 ; i < n ; ++i)
+                mask_[i] = valid(i) ? 1 : 0;
+        });
+        return mask_;
+    }
+
+    /**
+     * @brief Converted point cloud containing all valid points, computed on first access.
+     */
+    inline typename cloud_t::ConstPtr points() const
+    {
+        std::call_once(points_once_, [this]() {
+            const mask_t &m = mask();
+            typename cloud_t::Ptr points(new cloud_t);
+            for (std::size_t i = 0 ; i < m.size() ; ++i) {
+                if (m[i])
+                    points->insert(point(i));
+            }
+            points_ = points;
+        });
+        return points_;
+    }
+
+private:
+    msg_t                               msg_;
+    interval_t                          range_limits_;
+    bool                                xyz_double_;
+    std::array<std::size_t, 3>          offsets_;
+
+    mutable std::once_flag              mask_once_;
+    mutable mask_t                      mask_;
+    mutable std::once_flag              points_once_;
+    mutable typename cloud_t::ConstPtr  points_;
+
+    inline const sensor_msgs::PointField * findField(const std::string &name) const
+    {
+        for (const auto &f : msg_->fields) {
+            if (f.name == name)
+                return &f;
+        }
+        return nullptr;
+    }
+
+    inline T read(const std::size_t i,
+                  const std::size_t field_offset) const
+    {
+        const std::size_t w = msg_->width;
+        const std::size_t o = msg_->row_step == w * msg_->point_step ?
+                    i * msg_->point_step :
+                    (i / w) * msg_->row_step + (i % w) * msg_->point_step;
+        const uint8_t *ptr = msg_->data.data() + o + field_offset;
+        if (xyz_double_) {
+            double v;
+            std::memcpy(&v, ptr, sizeof(double));
+            return static_cast<T>(v);
+        }
+        float v;
+        std::memcpy(&v, ptr, sizeof(float));
+        return static_cast<T>(v);
+    }
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VIEW_HPP
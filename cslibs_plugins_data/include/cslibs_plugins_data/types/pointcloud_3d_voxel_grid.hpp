@@ -0,0 +1,217 @@
+#ifndef CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VOXEL_GRID_HPP
+#define CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VOXEL_GRID_HPP
+
+#include <cslibs_math_3d/linear/point.hpp>
+#include <cslibs_math_3d/linear/pointcloud.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace types {
+/**
+ * @brief The VoxelGrid class downsamples point clouds by binning points into
+ *        cubic cells. Binning is distributed over a worker pool, every chunk of
+ *        points is binned into hash partitions which are merged in parallel
+ *        afterwards. The output is ordered by the first point of each cell.
+ */
+template <typename T>
+class VoxelGrid
+{
+public:
+    using point_t   = cslibs_math_3d::Point3<T>;
+    using cloud_t   = cslibs_math_3d::Pointcloud3<T>;
+
+    enum class Policy { CENTROID, FIRST_POINT };
+
+    inline VoxelGrid(const T           leaf_size,
+                     const Policy      policy         = Policy::CENTROID,
+                     const std::size_t min_chunk_size = 4096) :
+        leaf_size_(leaf_size),
+        policy_(policy),
+        min_chunk_size_(std::max<std::size_t>(min_chunk_size, 1ul))
+    {
+    }
+
+    inline static Policy policyFromString(const std::string &policy)
+    {
+        return policy == "first" || policy == "first_point" ? Policy::FIRST_POINT : Policy::CENTROID;
+    }
+
+    inline T leafSize() const
+    {
+        return leaf_size_;
+    }
+
+    inline Policy policy() const
+    {
+        return policy_;
+    }
+
+    /**
+     * @brief Downsample points given by index based accessors.
+     * @param n         - amount of input points
+     * @param get       - functor returning the i-th point
+     * @param valid     - functor telling whether the i-th point shall be considered
+     * @param workers   - pool to distribute the work on, may be null
+     * @param dst       - the downsampled point cloud
+     */
+    template <typename Get, typename Valid>
+    inline void apply(const std::size_t       n,
+                      const Get              &get,
+                      const Valid            &valid,
+                      common::WorkerPool     *workers,
+                      typename cloud_t::Ptr  &dst) const
+    {
+        dst.reset(new cloud_t);
+        if (n == 0)
+            return;
+
+        const std::size_t threads = workers ? workers->size() + 1 : 1ul;
+        const std::size_t chunks  = std::max<std::size_t>(1ul, std::min(threads, n / min_chunk_size_));
+        const std::size_t chunk   = (n + chunks - 1) / chunks;
+        const std::size_t parts   = chunks;
+        const T           scale   = static_cast<T>(1) / leaf_size_;
+
+        /// bin every chunk into its own set of partitions
+        std::vector<std::vector<map_t>> binned(chunks, std::vector<map_t>(parts));
+        auto bin = [&](const std::size_t c) {
+            std::vector<map_t> &maps = binned[c];
+            const std::size_t end = std::min(n, (c + 1) * chunk);
+            for (std::size_t i = c * chunk ; i < end ; ++i) {
+                if (!valid(i))
+                    continue;
+                const point_t p = get(i);
+                const key_t   k = key(p, scale);
+                Cell &cell = maps[hash(k) % parts][k];
+                if (cell.n == 0)
+                    cell.first = i;
+                cell.sum[0] += p(0);
+                cell.sum[1] += p(1);
+                cell.sum[2] += p(2);
+                ++cell.n;
+            }
+        };
+        run(workers, chunks, bin);
+
+        /// merge the partitions, chunks are visited in order so first indices stay minimal
+        std::vector<std::vector<Cell>> merged(parts);
+        auto merge = [&](const std::size_t p) {
+            map_t &target = binned[0][p];
+            for (std::size_t c = 1 ; c < chunks ; ++c) {
+                for (const auto &entry : binned[c][p]) {
+                    Cell &cell = target[entry.first];
+                    if (cell.n == 0)
+                        cell.first = entry.second.first;
+                    cell.sum[0] += entry.second.sum[0];
+                    cell.sum[1] += entry.second.sum[1];
+                    cell.sum[2] += entry.second.sum[2];
+                    cell.n      += entry.second.n;
+                }
+            }
+            merged[p].reserve(target.size());
+            for (const auto &entry : target)
+                merged[p].emplace_back(entry.second);
+        };
+        run(workers, parts, merge);
+
+        std::vector<Cell> cells;
+        for (auto &m : merged)
+            cells.insert(cells.end(), m.begin(), m.end());
+        std::sort(cells.begin(), cells.end(),
+                  [](const Cell &a, const Cell &b) { return a.first < b.first; });
+
+        for (const Cell &cell : cells) {
+            if (policy_ == Policy::FIRST_POINT) {
+                dst->insert(get(cell.first));
+            } else {
+                const T inv = static_cast<T>(1) / static_cast<T>(cell.n);
+                dst->insert(point_t(cell.sum[0] * inv, cell.sum[1] * inv, cell.sum[2] * inv));
+            }
+        }
+    }
+
+    /**
+     * @brief Downsample a converted point cloud.
+     * @param src       - the input point cloud
+     * @param workers   - pool to distribute the work on, may be null
+     * @param dst       - the downsampled point cloud
+     */
+    inline void apply(const cloud_t          &src,
+                      common::WorkerPool     *workers,
+                      typename cloud_t::Ptr  &dst) const
+    {
+        const auto begin = src.begin();
+        apply(src.size(),
+              [&begin](const std::size_t i) { return point_t(begin[i]); },
+              [](const std::size_t) { return true; },
+              workers, dst);
+    }
+
+private:
+    /// integer cell indices, kept in full so distant cells never alias
+    struct key_t {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+
+        inline bool operator == (const key_t &other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct Hash {
+        inline std::size_t operator () (const key_t &k) const
+        {
+            return hash(k);
+        }
+    };
+
+    struct Cell {
+        T           sum[3]  = {0, 0, 0};
+        std::size_t n       = 0;
+        std::size_t first   = 0;
+    };
+    using map_t = std::unordered_map<key_t, Cell, Hash>;
+
+    T           leaf_size_;
+    Policy      policy_;
+    std::size_t min_chunk_size_;
+
+    inline static key_t key(const point_t &p, const T scale)
+    {
+        return {static_cast<int64_t>(std::floor(p(0) * scale)),
+                static_cast<int64_t>(std::floor(p(1) * scale)),
+                static_cast<int64_t>(std::floor(p(2) * scale))};
+    }
+
+    inline static std::size_t hash(const key_t &k)
+    {
+        /// mix every index into a 64 bit hash, neighbouring cells differ in the lower bits only
+        uint64_t h = static_cast<uint64_t>(k.x) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 29)) + static_cast<uint64_t>(k.y) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 29)) + static_cast<uint64_t>(k.z) * 0x94D049BB133111EBull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+
+    template <typename F>
+    inline static void run(common::WorkerPool *workers, const std::size_t n, const F &f)
+    {
+        if (workers) {
+            workers->parallelFor(n, f);
+        } else {
+            for (std::size_t i = 0 ; i < n ; ++i)
+                f(i);
+        }
+    }
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_TYPES_POINTCLOUD_3D_VOXEL_GRID_HPP
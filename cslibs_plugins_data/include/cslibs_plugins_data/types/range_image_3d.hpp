@@ -0,0 +1,175 @@
+#ifndef CSLIBS_PLUGINS_DATA_TYPES_RANGE_IMAGE_3D_HPP
+#define CSLIBS_PLUGINS_DATA_TYPES_RANGE_IMAGE_3D_HPP
+
+#include <cslibs_math_3d/linear/point.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cslibs_plugins_data {
+namespace types {
+/**
+ * @brief The RangeImage3 class keeps the organized layout of a 3D scan, rows
+ *        correspond to rings and columns to firing positions. Every cell holds
+ *        the point, the sensor range and a validity marker, invalid cells keep
+ *        their position in the image so neighbours can be looked up in O(1).
+ */
+template <typename T>
+class RangeImage3
+{
+public:
+    using Ptr      = std::shared_ptr<RangeImage3<T>>;
+    using ConstPtr = std::shared_ptr<const RangeImage3<T>>;
+    using point_t  = cslibs_math_3d::Point3<T>;
+
+    inline RangeImage3(const std::size_t rows,
+                       const std::size_t cols) :
+        rows_(rows),
+        cols_(cols),
+        x_(rows * cols, T()),
+        y_(rows * cols, T()),
+        z_(rows * cols, T()),
+        range_(rows * cols, T()),
+        valid_(rows * cols, 0)
+    {
+    }
+
+    inline std::size_t rows() const
+    {
+        return rows_;
+    }
+
+    inline std::size_t cols() const
+    {
+        return cols_;
+    }
+
+    inline std::size_t size() const
+    {
+        return valid_.size();
+    }
+
+    inline std::size_t index(const std::size_t row,
+                             const std::size_t col) const
+    {
+        return row * cols_ + col;
+    }
+
+    inline std::size_t row(const std::size_t index) const
+    {
+        return index / cols_;
+    }
+
+    inline std::size_t col(const std::size_t index) const
+    {
+        return index % cols_;
+    }
+
+    /**
+     * @brief Column index with wrap around, suited for spinning sensors.
+     * @param col   - column index, may be negative or exceed the image width
+     */
+    inline std::size_t wrapCol(const long col) const
+    {
+        const long c = static_cast<long>(cols_);
+        return static_cast<std::size_t>(((col % c) + c) % c);
+    }
+
+    inline bool valid(const std::size_t i) const
+    {
+        return valid_[i] != 0;
+    }
+
+    inline bool valid(const std::size_t row,
+                      const std::size_t col) const
+    {
+        return valid(index(row, col));
+    }
+
+    inline point_t point(const std::size_t i) const
+    {
+        return point_t(x_[i], y_[i], z_[i]);
+    }
+
+    inline point_t point(const std::size_t row,
+                         const std::size_t col) const
+    {
+        return point(index(row, col));
+    }
+
+    /**
+     * @brief Range measured by the sensor, 0 for invalid cells.
+     */
+    inline T range(const std::size_t i) const
+    {
+        return range_[i];
+    }
+
+    inline T range(const std::size_t row,
+                   const std::size_t col) const
+    {
+        return range(index(row, col));
+    }
+
+    inline void set(const std::size_t i,
+                    const T x, const T y, const T z,
+                    const T range)
+    {
+        x_[i]     = x;
+        y_[i]     = y;
+        z_[i]     = z;
+        range_[i] = range;
+        valid_[i] = 1;
+    }
+
+    inline void setInvalid(const std::size_t i)
+    {
+        x_[i]     = T();
+        y_[i]     = T();
+        z_[i]     = T();
+        range_[i] = T();
+        valid_[i] = 0;
+    }
+
+    /**
+     * @brief Raw channels for image space processing.
+     */
+    inline const std::vector<T>& x() const
+    {
+        return x_;
+    }
+
+    inline const std::vector<T>& y() const
+    {
+        return y_;
+    }
+
+    inline const std::vector<T>& z() const
+    {
+        return z_;
+    }
+
+    inline const std::vector<T>& ranges() const
+    {
+        return range_;
+    }
+
+    inline const std::vector<uint8_t>& mask() const
+    {
+        return valid_;
+    }
+
+private:
+    std::size_t          rows_;
+    std::size_t          cols_;
+    std::vector<T>       x_;
+    std::vector<T>       y_;
+    std::vector<T>       z_;
+    std::vector<T>       range_;
+    std::vector<uint8_t> valid_;
+};
+}
+}
+
+#endif // CSLIBS_PLUGINS_DATA_TYPES_RANGE_IMAGE_3D_HPP
@@ -4,3 +4,5 @@
 CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::LaserProvider,   cslibs_plugins_data::DataProvider)
 CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::LaserProvider_d, cslibs_plugins_data::DataProvider)
 CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::LaserProvider_f, cslibs_plugins_data::DataProvider)
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::MultiEchoLaserProvider_d, cslibs_plugins_data::DataProvider)
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::MultiEchoLaserProvider_f, cslibs_plugins_data::DataProvider)
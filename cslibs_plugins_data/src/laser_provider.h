@@ -2,24 +2,66 @@
 #define CSLIBS_PLUGINS_DATA_LASER_PROVIDER_H
 
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/MultiEchoLaserScan.h>
 
+#include <cslibs_plugins_data/common/throttled_subscription.hpp>
 #include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/common/deferred_transform_queue.hpp>
+#include <cslibs_plugins_data/common/static_transform_cache.hpp>
 #include <cslibs_plugins_data/types/laserscan.hpp>
 #include <cslibs_plugins_data/types/laserscan_convert.hpp>
 #include <cslibs_math_2d/linear/point.hpp>
 
+#include <mutex>
+
 namespace cslibs_plugins_data {
-template <typename T>
+namespace detail {
+template <typename Msg>
+struct laser_message;
+
+template <>
+struct laser_message<sensor_msgs::LaserScan>
+{
+    inline static const char* topic() { return "/scan"; }
+    inline static const char* name()  { return "laserscan"; }
+};
+
+template <>
+struct laser_message<sensor_msgs::MultiEchoLaserScan>
+{
+    inline static const char* topic() { return "/echoes"; }
+    inline static const char* name()  { return "multi echo laserscan"; }
+};
+}
+
+/**
+ * @brief Provides laserscans converted from sensor_msgs::LaserScan, or from
+ *        sensor_msgs::MultiEchoLaserScan keeping all echoes per beam.
+ */
+template <typename T, typename Msg = sensor_msgs::LaserScan>
 class LaserProviderBase : public DataProvider
 {
 public:
-    using point_t = cslibs_math_2d::Point2<T>;
+    using point_t   = cslibs_math_2d::Point2<T>;
+    using msg_t     = Msg;
+    using msg_ptr_t = typename Msg::ConstPtr;
 
     LaserProviderBase() :
         time_offset_(0.0)
     {
     }
-    virtual ~LaserProviderBase() = default;
+    virtual ~LaserProviderBase()
+    {
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        source_.shutdown();
+        deferred_.shutdown();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Laserscan2<T>::staticType();
+    }
 
 protected:
     ros::Subscriber         source_;                    /// the subscriber to be used
@@ -27,48 +69,160 @@ protected:
     bool                    enforce_stamp_;             /// Enforce that start_time = stamp = end_time
 
     ros::Duration           time_offset_;
-    ros::Time               time_of_last_measurement_;
+    ros::Time               time_of_last_measurement_;  /// stamp of the last emitted scan
+    std::mutex              throttle_mutex_;            /// deferred retries emit besides the callback
 
     bool                    transform_;
     std::string             transform_to_frame_;
+    common::StaticTransformCache<T> static_transforms_;  /// skips tf lookups for static chains
+    bool                    deferred_tf_;               /// park messages instead of waiting for tf
 
     std::array<T, 2>        range_limits_;
+    bool                    intensities_;               /// keep intensities aligned with the rays
 
-    virtual void callback(const sensor_msgs::LaserScanConstPtr &msg)
+    common::DeferredTransformQueue<msg_ptr_t> deferred_;
+
+    virtual void callback(const msg_ptr_t &msg)
     {
-        if (!time_offset_.isZero() && !time_of_last_measurement_.isZero())
-            if (msg->header.stamp <= (time_of_last_measurement_ + time_offset_))
+        recordReceived(msg->header.stamp);
+        {
+            std::unique_lock<std::mutex> l(throttle_mutex_);
+            if (throttled(msg->header.stamp)) {
+                ++stats_.throttled;
                 return;
+            }
+        }
+
+        if (transform_ && deferred_tf_) {
+            deferred_.push(msg);
+        } else if (transform_) {
+            if (!convertTransformed(msg, tf_timeout_))
+                ++stats_.failed_tf;
+        } else {
+            typename types::Laserscan2<T>::Ptr laserscan;
+            bool converted;
+            {
+                stats_t::ScopedTimer timer(stats_.conversion);
+                converted = convert(msg, range_limits_, laserscan, enforce_stamp_, intensities_);
+            }
+            if (converted)
+                emitThrottled(msg->header.stamp, laserscan);
+        }
+    }
+
+    inline bool throttled(const ros::Time &stamp) const
+    {
+        return !time_offset_.isZero() && !time_of_last_measurement_.isZero() &&
+                stamp <= (time_of_last_measurement_ + time_offset_);
+    }
+
+    /**
+     * @brief Emit unless a scan within the throttling period has been emitted
+     *        meanwhile, which happens if parked messages are converted late.
+     *        Only emitted scans advance the throttling.
+     */
+    inline void emitThrottled(const ros::Time &stamp,
+                              const typename types::Laserscan2<T>::Ptr &laserscan)
+    {
+        {
+            std::unique_lock<std::mutex> l(throttle_mutex_);
+            if (throttled(stamp)) {
+                ++stats_.throttled;
+                return;
+            }
+            time_of_last_measurement_ = stamp;
+        }
+        emit(laserscan);
+    }
+
+    /**
+     * @brief Convert into the target frame, waiting at most timeout for the transform.
+     * @return false if the transform is not available
+     */
+    inline bool convertTransformed(const msg_ptr_t &msg,
+                                   const ros::Duration &timeout)
+    {
+        cslibs_math_3d::Transform3<T> t_T_l;
+        {
+            stats_t::ScopedTimer timer(stats_.tf_wait);
+            if (!static_transforms_.lookup(*tf_, transform_to_frame_, msg->header.frame_id, msg->header.stamp, t_T_l, timeout))
+                return false;
+        }
 
         typename types::Laserscan2<T>::Ptr laserscan;
-        if (transform_ ? convert(msg, tf_, transform_to_frame_, tf_timeout_, range_limits_, laserscan, enforce_stamp_) :
-                         convert(msg, range_limits_, laserscan, enforce_stamp_))
-            data_received_(laserscan);
+        bool converted;
+        {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            converted = convert(msg, t_T_l, transform_to_frame_, range_limits_, laserscan, enforce_stamp_, intensities_);
+        }
+        if (converted)
+            emitThrottled(msg->header.stamp, laserscan);
+        return true;
+    }
 
-        time_of_last_measurement_ = msg->header.stamp;
+    void throttledCallback(const typename common::ThrottledMessage<Msg>::ConstPtr &msg)
+    {
+        if (!msg->msg) {
+            recordReceived(msg->stamp);
+            ++stats_.throttled;
+            return;
+        }
+        callback(msg->msg);
     }
 
     virtual void doSetup(ros::NodeHandle &nh) override
     {
-        auto param_name = [this](const std::string &name){return name_ + "/" + name;};
-
-        const int queue_size        = nh.param<int>(param_name("queue_size"), 1);
+        doSetup(nh, nh);
+    }
 
-        topic_                      = nh.param<std::string>(param_name("topic"), "/scan");
-        source_                     = nh.subscribe(topic_, queue_size, &LaserProviderBase::callback, this);
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
+    {
+        auto param_name = [this](const std::string &name){return name_ + "/" + name;};
 
-        enforce_stamp_              = nh.param<bool>(param_name("enforce_stamp"), true);
+        const int queue_size        = private_nh.param<int>(param_name("queue_size"), 1);
+
+        topic_                      = private_nh.param<std::string>(param_name("topic"), detail::laser_message<Msg>::topic());
+
+        enforce_stamp_              = private_nh.param<bool>(param_name("enforce_stamp"), true);
+
+        transform_                  = private_nh.param<bool>(param_name("transform"), false);
+        transform_to_frame_         = private_nh.param<std::string>(param_name("transform_to_frame"), "base_link");
+        if (transform_)
+            static_transforms_.setup(private_nh.param<bool>(param_name("static_transform"), false),
+                                     private_nh.param<bool>(param_name("detect_static_transforms"), true));
+
+        deferred_tf_                = transform_ && private_nh.param<bool>(param_name("deferred_tf"), false);
+        if (deferred_tf_) {
+            /// never wait for tf in the callback, retry parked messages on the
+            /// subscriber's callback queue until tf_timeout instead
+            const int pending       = private_nh.param<int>(param_name("deferred_tf_queue_size"), 10);
+            const double period     = private_nh.param<double>(param_name("deferred_tf_retry_period"), 0.01);
+            deferred_.setup(executor(), nh.getCallbackQueue(), static_cast<std::size_t>(std::max(pending, 1)),
+                            std::chrono::nanoseconds(tf_timeout_.toNSec()),
+                            std::chrono::nanoseconds(static_cast<int64_t>(period * 1e9)),
+                            [this](const msg_ptr_t &msg) { return convertTransformed(msg, ros::Duration(0.0)); },
+                            [this](const msg_ptr_t &) { ++stats_.failed_tf; });
+        }
 
-        transform_                  = nh.param<bool>(param_name("transform"), false);
-        transform_to_frame_         = nh.param<std::string>(param_name("transform_to_frame"), "base_link");
+        range_limits_               = {static_cast<T>(private_nh.param<double>(param_name("range_min"), 0.0)),
+                                       static_cast<T>(private_nh.param<double>(param_name("range_max"), std::numeric_limits<T>::max()))};
 
-        range_limits_               = {static_cast<T>(nh.param<double>(param_name("range_min"), 0.0)),
-                                       static_cast<T>(nh.param<double>(param_name("range_max"), std::numeric_limits<double>::max()))};
+        intensities_                = private_nh.param<bool>(param_name("intensities"), false);
 
-        double rate                 = nh.param<double>(param_name("rate"), 0.0);
+        double rate                 = private_nh.param<double>(param_name("rate"), 0.0);
         if (rate > 0.0) {
             time_offset_ = ros::Duration(1.0 / rate);
-            ROS_INFO_STREAM(name_ << ": Throttling laserscan to rate of " << rate << "Hz!");
+            ROS_INFO_STREAM(name_ << ": Throttling " << detail::laser_message<Msg>::name() << " to rate of " << rate << "Hz!");
+        }
+
+        if (!time_offset_.isZero() && throttleSerialized(private_nh)) {
+            /// drop messages before they are deserialized
+            using throttled_t = common::ThrottledMessage<Msg>;
+            common::RateGate::Ptr gate(new common::RateGate(time_offset_));
+            source_ = common::subscribeThrottled<Msg>(nh, topic_, static_cast<uint32_t>(queue_size), gate,
+                                                      [this](const typename throttled_t::ConstPtr &msg) { throttledCallback(msg); });
+        } else {
+            source_ = nh.subscribe(topic_, queue_size, &LaserProviderBase::callback, this);
         }
     }
 };
@@ -76,6 +230,9 @@ protected:
 using LaserProvider   = LaserProviderBase<double>; // for backwards compatibility
 using LaserProvider_d = LaserProviderBase<double>;
 using LaserProvider_f = LaserProviderBase<float>;
+
+using MultiEchoLaserProvider_d = LaserProviderBase<double, sensor_msgs::MultiEchoLaserScan>;
+using MultiEchoLaserProvider_f = LaserProviderBase<float,  sensor_msgs::MultiEchoLaserScan>;
 }
 
 #endif // CSLIBS_PLUGINS_DATA_LASER_PROVIDER_H
@@ -0,0 +1,5 @@
+#include "merged_laser_provider.h"
+
+#include <class_loader/register_macro.hpp>
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::MergedLaserProvider_d, cslibs_plugins_data::DataProvider)
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::MergedLaserProvider_f, cslibs_plugins_data::DataProvider)
@@ -0,0 +1,325 @@
+#ifndef CSLIBS_PLUGINS_DATA_MERGED_LASER_PROVIDER_H
+#define CSLIBS_PLUGINS_DATA_MERGED_LASER_PROVIDER_H
+
+#include <sensor_msgs/LaserScan.h>
+#include <boost/function.hpp>
+
+#include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/common/queued_call.hpp>
+#include <cslibs_plugins_data/common/static_transform_cache.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
+#include <cslibs_plugins_data/types/laserscan.hpp>
+#include <cslibs_plugins_data/types/laserscan_convert.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+namespace cslibs_plugins_data {
+/**
+ * @brief Merges the scans of several planar lasers into one scan in a common
+ *        frame. Scans with stamps inside a synchronisation window are converted
+ *        in parallel and emitted as one Laserscan2, each ray carrying the origin
+ *        of its sensor as start point. A window is closed once every laser
+ *        contributed, a scan of the next window arrives or it timed out, so
+ *        that a failing laser does not hold back the others.
+ */
+template <typename T>
+class MergedLaserProviderBase : public DataProvider
+{
+public:
+    using laserscan_t = types::Laserscan2<T>;
+
+    MergedLaserProviderBase() :
+        sync_window_(0.0),
+        min_scans_(0ul),
+        window_timeout_(0),
+        expiry_posted_(false),
+        queue_(nullptr),
+        enforce_stamp_(true),
+        intensities_(false)
+    {
+    }
+    virtual ~MergedLaserProviderBase()
+    {
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        if (expiry_task_)
+            expiry_task_->cancel();
+        if (queue_)
+            queue_->removeByID(ownerId());
+        for (auto &source : sources_)
+            source.shutdown();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Laserscan2<T>::staticType();
+    }
+
+protected:
+    std::vector<ros::Subscriber>                 sources_;       /// one subscriber per laser
+    std::vector<std::string>                     topics_;
+
+    std::mutex                                   window_mutex_;
+    std::vector<sensor_msgs::LaserScanConstPtr>  window_;        /// latest scan of each laser in the open window
+    ros::Time                                    window_start_;
+    ros::Duration                                sync_window_;
+    std::size_t                                  min_scans_;     /// minimum amount of scans to merge a window
+
+    common::Executor::time_point_t               window_opened_; /// arrival of the window's first scan
+    common::Executor::duration_t                 window_timeout_;
+    bool                                         expiry_posted_; /// an expiry check waits in the callback queue
+    ros::CallbackQueueInterface                 *queue_;
+    common::Executor::Task::Ptr                  expiry_task_;
+
+    bool                                         enforce_stamp_;
+    bool                                         intensities_;
+    std::string                                  transform_to_frame_;
+    common::StaticTransformCache<T>              static_transforms_;  /// skips tf lookups for static chains
+    std::array<T, 2>                             range_limits_;
+
+    common::WorkerPool::Ptr                      workers_;
+
+    void callback(const std::size_t laser, const sensor_msgs::LaserScanConstPtr &msg)
+    {
+        recordReceived(msg->header.stamp);
+
+        std::vector<sensor_msgs::LaserScanConstPtr> closed;
+        {
+            std::unique_lock<std::mutex> l(window_mutex_);
+            const bool empty = std::none_of(window_.begin(), window_.end(),
+                                            [](const sensor_msgs::LaserScanConstPtr &s) { return static_cast<bool>(s); });
+            if (empty) {
+                open(msg->header.stamp);
+            } else if (window_start_ + sync_window_ < msg->header.stamp) {
+                /// message belongs to the next window, close the current one
+                closed.swap(window_);
+                window_.resize(closed.size());
+                open(msg->header.stamp);
+            }
+            if (window_[laser])
+                ++stats_.throttled;                              /// superseded within the window
+            window_[laser] = msg;
+
+            if (closed.empty() && std::all_of(window_.begin(), window_.end(),
+                                              [](const sensor_msgs::LaserScanConstPtr &s) { return static_cast<bool>(s); })) {
+                closed.swap(window_);
+                window_.resize(closed.size());
+            }
+        }
+        close(closed);
+    }
+
+    inline void open(const ros::Time &stamp)
+    {
+        window_start_  = stamp;
+        window_opened_ = common::Executor::clock_t::now();
+    }
+
+    inline void close(std::vector<sensor_msgs::LaserScanConstPtr> &closed)
+    {
+        closed.erase(std::remove(closed.begin(), closed.end(), sensor_msgs::LaserScanConstPtr()), closed.end());
+        if (closed.empty())
+            return;
+        if (closed.size() < min_scans_) {
+            stats_.throttled += closed.size();
+            return;
+        }
+        merge(closed);
+    }
+
+    inline uint64_t ownerId() const
+    {
+        return reinterpret_cast<uint64_t>(this);
+    }
+
+    /**
+     * @brief Run on the executor, hands a timed out window over to the callback
+     *        queue, so that it is merged by the threads serving the subscribers.
+     */
+    inline void postExpiry()
+    {
+        {
+            std::unique_lock<std::mutex> l(window_mutex_);
+            if (expiry_posted_ || !expired())
+                return;
+            expiry_posted_ = true;
+        }
+        common::QueuedCall::post(queue_, [this]() { expire(); }, ownerId());
+    }
+
+    inline void expire()
+    {
+        std::vector<sensor_msgs::LaserScanConstPtr> closed;
+        {
+            std::unique_lock<std::mutex> l(window_mutex_);
+            expiry_posted_ = false;
+            if (!expired())
+                return;
+            closed.swap(window_);
+            window_.resize(closed.size());
+        }
+        close(closed);
+    }
+
+    inline bool expired() const
+    {
+        return std::any_of(window_.begin(), window_.end(),
+                           [](const sensor_msgs::LaserScanConstPtr &s) { return static_cast<bool>(s); }) &&
+                common::Executor::clock_t::now() >= window_opened_ + window_timeout_;
+    }
+
+    void merge(const std::vector<sensor_msgs::LaserScanConstPtr> &scans)
+    {
+        /// look up on the calling thread, waiting for tf must not occupy the (shared) workers
+        std::vector<sensor_msgs::LaserScanConstPtr> found;
+        std::vector<cslibs_math_3d::Transform3<T>, Eigen::aligned_allocator<cslibs_math_3d::Transform3<T>>> transforms;
+        found.reserve(scans.size());
+        transforms.reserve(scans.size());
+        for (const auto &msg : scans) {
+            cslibs_math_3d::Transform3<T> t_T_l;
+            bool available;
+            {
+                stats_t::ScopedTimer timer(stats_.tf_wait);
+                available = static_transforms_.lookup(*tf_, transform_to_frame_, msg->header.frame_id, msg->header.stamp, t_T_l, tf_timeout_);
+            }
+            if (!available) {
+                ++stats_.failed_tf;
+                continue;
+            }
+            found.emplace_back(msg);
+            transforms.emplace_back(t_T_l);
+        }
+
+        std::vector<typename laserscan_t::Ptr> converted(found.size());
+        auto convert_scan = [this, &found, &transforms, &converted](const std::size_t i) {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            if (!types::convert(found[i], transforms[i], transform_to_frame_, range_limits_, converted[i], enforce_stamp_, intensities_))
+                converted[i].reset();
+        };
+        if (workers_)
+            workers_->parallelFor(found.size(), convert_scan);
+        else
+            for (std::size_t i = 0 ; i < found.size() ; ++i)
+                convert_scan(i);
+
+        converted.erase(std::remove(converted.begin(), converted.end(), typename laserscan_t::Ptr()), converted.end());
+        if (converted.empty())
+            return;
+
+        typename laserscan_t::Ptr merged;
+        {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            merged = concatenate(converted);
+        }
+        emit(merged);
+    }
+
+    typename laserscan_t::Ptr concatenate(const std::vector<typename laserscan_t::Ptr> &scans) const
+    {
+        const laserscan_t &first = *scans.front();
+        cslibs_time::Time start    = first.timeFrame().start;
+        cslibs_time::Time end      = first.timeFrame().end;
+        cslibs_time::Time received = first.stampReceived();
+        T linear_min = first.getLinearMin();
+        T linear_max = first.getLinearMax();
+        T angular_min = std::numeric_limits<T>::max();
+        T angular_max = std::numeric_limits<T>::lowest();
+        std::size_t rays = 0ul;
+        bool intensities = true;
+        for (const auto &scan : scans) {
+            start      = std::min(start, scan->timeFrame().start);
+            end        = std::max(end, scan->timeFrame().end);
+            received   = std::max(received, scan->stampReceived());
+            linear_min = std::min(linear_min, scan->getLinearMin());
+            linear_max = std::max(linear_max, scan->getLinearMax());
+            rays      += scan->getRays().size();
+            intensities &= scan->hasIntensities();
+            for (const auto &ray : scan->getRays()) {
+                if (ray.valid()) {
+                    angular_min = std::min(angular_min, ray.angle);
+                    angular_max = std::max(angular_max, ray.angle);
+                }
+            }
+        }
+        /// the rays are seen from their sensors, covering the directions of all of them
+        if (angular_min > angular_max) {
+            angular_min = static_cast<T>(-M_PI);
+            angular_max = static_cast<T>(M_PI);
+        }
+
+        typename laserscan_t::Ptr merged(new laserscan_t(transform_to_frame_,
+                                                         cslibs_time::TimeFrame(start, end),
+                                                         {linear_min, linear_max},
+                                                         {angular_min, angular_max},
+                                                         received));
+        merged->reserve(rays);
+        if (intensities)
+            merged->reserveIntensities(rays);
+        for (const auto &scan : scans) {
+            for (const auto &ray : scan->getRays())
+                merged->insert(ray);
+            if (intensities)
+                for (const auto intensity : scan->getIntensities())
+                    merged->insertIntensity(intensity);
+        }
+        return merged;
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
+    {
+        auto param_name = [this](const std::string &name){return name_ + "/" + name;};
+
+        const int queue_size    = private_nh.param<int>(param_name("queue_size"), 1);
+        topics_                 = private_nh.param<std::vector<std::string>>(param_name("topics"), std::vector<std::string>());
+        if (topics_.empty()) {
+            ROS_ERROR_STREAM(name_ << ": No laser topics given, nothing will be merged!");
+            return;
+        }
+
+        enforce_stamp_          = private_nh.param<bool>(param_name("enforce_stamp"), true);
+        intensities_            = private_nh.param<bool>(param_name("intensities"), false);
+        transform_to_frame_     = private_nh.param<std::string>(param_name("transform_to_frame"), "base_link");
+        static_transforms_.setup(private_nh.param<bool>(param_name("static_transform"), false),
+                                 private_nh.param<bool>(param_name("detect_static_transforms"), true));
+        range_limits_           = {static_cast<T>(private_nh.param<double>(param_name("range_min"), 0.0)),
+                                   static_cast<T>(private_nh.param<double>(param_name("range_max"), std::numeric_limits<T>::max()))};
+
+        sync_window_            = ros::Duration(private_nh.param<double>(param_name("sync_window"), 0.05));
+        min_scans_              = static_cast<std::size_t>(std::max(1, private_nh.param<int>(param_name("min_scans"), static_cast<int>(topics_.size()))));
+
+        /// by default leave twice the synchronisation window for transport delays
+        const double window_timeout = std::max(private_nh.param<double>(param_name("window_timeout"), 2.0 * sync_window_.toSec()), 1e-3);
+        window_timeout_         = std::chrono::duration_cast<common::Executor::duration_t>(std::chrono::duration<double>(window_timeout));
+
+        const int threads       = private_nh.param<int>(param_name("threads"), static_cast<int>(topics_.size()));
+        if (threads > 1) {
+            workers_ = private_nh.param<bool>(param_name("shared_workers"), true) ?
+                        common::WorkerPool::limit(common::WorkerPool::shared(), static_cast<std::size_t>(threads)) :
+                        common::WorkerPool::Ptr(new common::WorkerPool(static_cast<std::size_t>(threads - 1),
+                                                                        [this]() { applyThreadSettings(); }));
+        }
+
+        window_.resize(topics_.size());
+        for (std::size_t i = 0 ; i < topics_.size() ; ++i) {
+            const boost::function<void(const sensor_msgs::LaserScanConstPtr &)> cb =
+                    [this, i](const sensor_msgs::LaserScanConstPtr &msg) { callback(i, msg); };
+            sources_.emplace_back(nh.subscribe<sensor_msgs::LaserScan>(topics_[i], static_cast<uint32_t>(queue_size), cb));
+        }
+
+        queue_       = nh.getCallbackQueue();
+        expiry_task_ = executor()->scheduleEvery([this]() { postExpiry(); }, window_timeout_ / 2);
+        ROS_INFO_STREAM(name_ << ": Merging " << topics_.size() << " laserscans into frame '" << transform_to_frame_ << "'!");
+    }
+};
+
+using MergedLaserProvider_d = MergedLaserProviderBase<double>;
+using MergedLaserProvider_f = MergedLaserProviderBase<float>;
+}
+
+#endif // CSLIBS_PLUGINS_DATA_MERGED_LASER_PROVIDER_H
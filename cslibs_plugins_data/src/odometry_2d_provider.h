@@ -8,13 +8,30 @@
 #include <cslibs_plugins_data/types/odometry_2d.hpp>
 #include <tf/tf.h>
 
+#include <mutex>
+
 namespace cslibs_plugins_data {
 template <typename T>
 class Odometry2DProviderBase : public DataProvider
 {
 public:
-    Odometry2DProviderBase() = default;
-    virtual ~Odometry2DProviderBase() = default;
+    Odometry2DProviderBase() :
+        coalesce_(false),
+        coalesce_linear_(0),
+        coalesce_angular_(0)
+    {
+    }
+    virtual ~Odometry2DProviderBase()
+    {
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        source_.shutdown();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Odometry2<T>::staticType();
+    }
 
 protected:
     ros::Subscriber source_;
@@ -22,45 +39,123 @@ protected:
 
     nav_msgs::Odometry::ConstPtr last_msg_;
 
+    bool                         coalesce_;         /// merge consecutive messages into one update
+    ros::Duration                coalesce_period_;
+    T                            coalesce_linear_;
+    T                            coalesce_angular_;
+    nav_msgs::Odometry::ConstPtr span_start_;       /// last message already pushed through
+    std::mutex                   span_mutex_;
+
+    inline static cslibs_math_2d::Pose2<T> toPose(const nav_msgs::OdometryConstPtr &msg)
+    {
+        return cslibs_math_2d::Pose2<T>(msg->pose.pose.position.x,
+                                        msg->pose.pose.position.y,
+                                        tf::getYaw(msg->pose.pose.orientation));
+    }
+
+    inline typename types::Odometry2<T>::Ptr create(const nav_msgs::OdometryConstPtr &start,
+                                                    const nav_msgs::OdometryConstPtr &end) const
+    {
+        cslibs_time::TimeFrame time_frame(start->header.stamp.toNSec(),
+                                          end->header.stamp.toNSec());
+        return typename types::Odometry2<T>::Ptr(new types::Odometry2<T>(end->header.frame_id,
+                                                                         time_frame,
+                                                                         toPose(start),
+                                                                         toPose(end),
+                                                                         cslibs_time::Time(std::max(end->header.stamp.toNSec(),
+                                                                                                    ros::Time::now().toNSec()))));
+    }
+
     void callback(const nav_msgs::OdometryConstPtr &msg)
     {
-        auto to_pose = [](const nav_msgs::OdometryConstPtr &msg) {
-            return cslibs_math_2d::Pose2<T>(msg->pose.pose.position.x,
-                                             msg->pose.pose.position.y,
-                                             tf::getYaw(msg->pose.pose.orientation));
-        };
+        recordReceived(msg->header.stamp);
+        if (coalesce_) {
+            coalesce(msg);
+            return;
+        }
 
         typename types::Odometry2<T>::Ptr odometry;
-        if (last_msg_) {
-            cslibs_time::TimeFrame time_frame(last_msg_->header.stamp.toNSec(),
-                                              msg->header.stamp.toNSec());
-            odometry.reset(new types::Odometry2<T>(msg->header.frame_id,
-                                                   time_frame,
-                                                   to_pose(last_msg_),
-                                                   to_pose(msg),
-                                                   cslibs_time::Time(std::max(msg->header.stamp.toNSec(),
-                                                                               ros::Time::now().toNSec()))));
-        } else {
-            cslibs_time::TimeFrame time_frame(msg->header.stamp.toNSec(),
-                                              msg->header.stamp.toNSec());
-            odometry.reset(new types::Odometry2<T>(msg->header.frame_id,
-                                                   time_frame,
-                                                   to_pose(msg),
-                                                   to_pose(msg),
-                                                   cslibs_time::Time(std::max(msg->header.stamp.toNSec(),
-                                                                               ros::Time::now().toNSec()))));
+        {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            odometry = create(last_msg_ ? last_msg_ : msg, msg);
         }
-
-        data_received_(odometry);
+        emit(odometry);
         last_msg_ = msg;
     }
 
+    void coalesce(const nav_msgs::OdometryConstPtr &msg)
+    {
+        typename types::Odometry2<T>::Ptr odometry;
+        {
+            std::unique_lock<std::mutex> l(span_mutex_);
+            if (!span_start_) {
+                odometry    = create(msg, msg);
+                span_start_ = msg;
+            } else {
+                const cslibs_math_2d::Pose2<T> start = toPose(span_start_);
+                const cslibs_math_2d::Pose2<T> end   = toPose(msg);
+                const bool period  = !coalesce_period_.isZero() &&
+                                     msg->header.stamp - span_start_->header.stamp >= coalesce_period_;
+                const bool linear  = coalesce_linear_ > T() &&
+                                     (end.translation() - start.translation()).length() >= coalesce_linear_;
+                const bool angular = coalesce_angular_ > T() &&
+                                     std::abs(cslibs_math::common::angle::difference(end.yaw(), start.yaw())) >= coalesce_angular_;
+                if (period || linear || angular) {
+                    odometry    = create(span_start_, msg);
+                    span_start_ = msg;
+                }
+            }
+            last_msg_ = msg;
+        }
+        if (odometry)
+            emit(odometry);
+        else
+            ++stats_.throttled;
+    }
+
+    virtual void flush() override
+    {
+        if (!coalesce_)
+            return;
+
+        typename types::Odometry2<T>::Ptr odometry;
+        {
+            std::unique_lock<std::mutex> l(span_mutex_);
+            if (!span_start_ || !last_msg_ || span_start_ == last_msg_)
+                return;
+            odometry    = create(span_start_, last_msg_);
+            span_start_ = last_msg_;
+        }
+        emit(odometry);
+    }
+
     virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
     {
         auto param_name = [this](const std::string &name){return name_ + "/" + name;};
 
-        const int queue_size = nh.param<int>(param_name("queue_size"), 1);
-        topic_ = nh.param<std::string>(param_name("topic"), "/odom");
+        const int queue_size = private_nh.param<int>(param_name("queue_size"), 1);
+        topic_ = private_nh.param<std::string>(param_name("topic"), "/odom");
+
+        coalesce_           = private_nh.param<bool>(param_name("coalesce"), false);
+        coalesce_period_    = ros::Duration(private_nh.param<double>(param_name("coalesce_period"), 0.0));
+        coalesce_linear_    = static_cast<T>(private_nh.param<double>(param_name("coalesce_linear"), 0.0));
+        coalesce_angular_   = static_cast<T>(private_nh.param<double>(param_name("coalesce_angular"), 0.0));
+        if (coalesce_ && coalesce_period_ <= ros::Duration(0.0) && coalesce_linear_ <= T() && coalesce_angular_ <= T()) {
+            /// no span would ever be closed, odometry would only be emitted on flush()
+            ROS_WARN_STREAM(name_ << ": Coalescing requires a positive period or threshold, disabling coalescing!");
+            coalesce_ = false;
+        }
+        if (coalesce_)
+            ROS_INFO_STREAM(name_ << ": Coalescing odometry with period " << coalesce_period_.toSec() << "s, "
+                            << "linear threshold " << coalesce_linear_ << "m and "
+                            << "angular threshold " << coalesce_angular_ << "rad!");
+
+        /// subscribe last, callbacks may run right away on a multi threaded spinner
         source_= nh.subscribe(topic_, queue_size, &Odometry2DProviderBase::callback, this);
     }
 };
@@ -2,10 +2,12 @@
 #define CSLIBS_PLUGINS_DATA_ODOMETRY_2D_PROVIDER_TF_H
 
 #include <ros/ros.h>
-#include <thread>
-#include <atomic>
+#include <ros/callback_queue.h>
+#include <tf2_msgs/TFMessage.h>
 
 #include <cslibs_math_ros/tf/tf_listener.hpp>
+#include <cslibs_plugins_data/common/executor.hpp>
+#include <cslibs_plugins_data/common/queue_spinner.hpp>
 #include <cslibs_plugins_data/data_provider.hpp>
 #include <cslibs_plugins_data/types/odometry_2d.hpp>
 #include <tf/tf.h>
@@ -23,18 +25,26 @@ public:
         o_T_b1_(cslibs_math_2d::Transform2<T>(), cslibs_time::Time(ros::Time::now().toNSec()).time()),
         initialized_(false),
         rate_(60.0),
-        running_(false),
-        stop_(false)
+        poll_pending_(false),
+        event_driven_(false)
     {
     }
 
     virtual ~Odometry2DProviderTFBase()
     {
-        if( running_) {
-            stop_ = true;
-            if (worker_thread_.joinable())
-                worker_thread_.join();
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        if (event_driven_) {
+            tf_source_.shutdown();
+            tf_spinner_.reset();
         }
+        if (poll_task_)
+            poll_task_->cancel();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Odometry2<T>::staticType();
     }
 
 protected:
@@ -44,45 +54,153 @@ protected:
     stamped_t        o_T_b1_;
     bool             initialized_;
     ros::Rate        rate_;
-    std::atomic_bool running_;
-    std::atomic_bool stop_;
-    std::thread      worker_thread_;
 
-    void loop()
+    /// polling runs on the provider's executor and never waits for tf, its
+    /// period follows the steady clock, under use_sim_time it thus does not
+    /// scale with the simulation rate
+    common::Executor::Task::Ptr         poll_task_;
+    common::Executor::duration_t        poll_period_;
+    common::Executor::duration_t        poll_retry_period_;     /// retry period while tf is not available yet
+    common::Executor::time_point_t      poll_tick_;             /// due time of the pending poll
+    common::Executor::time_point_t      poll_deadline_;
+    ros::Time                           poll_stamp_;            /// stamp of the pending poll
+    bool                                poll_pending_;          /// the transform of the last poll is not available yet
+
+    bool                                event_driven_;          /// react on tf messages instead of polling
+    std::string                         odom_frame_id_;         /// frame ids as published on tf
+    std::string                         base_frame_id_;
+    ros::CallbackQueue                  tf_queue_;
+    std::unique_ptr<common::QueueSpinner> tf_spinner_;
+    ros::Subscriber                     tf_source_;
+    ros::Time                           last_update_;
+    ros::Duration                       stationary_period_;     /// minimum period between updates while not moving
+    T                                   stationary_linear_;
+    T                                   stationary_angular_;
+
+    bool poll(common::Executor::time_point_t &due)
     {
-        running_ = true;
-        while (!stop_) {
-            const ros::Time now = ros::Time::now();
-            stamped_t o_T_b2(cslibs_math_2d::Transform2<T>(), cslibs_time::Time(now.toNSec()).time());
-            if (tf_->lookupTransform(odom_frame_, base_frame_, now, o_T_b2, tf_timeout_)) {
-                if (initialized_) {
-                    cslibs_time::TimeFrame time_frame(o_T_b1_.stamp(), o_T_b2.stamp());
-                    typename types::Odometry2<T>::Ptr odometry(new types::Odometry2<T>(odom_frame_,
-                                                                                       time_frame,
-                                                                                       o_T_b1_.data(),
-                                                                                       o_T_b2.data(),
-                                                                                       cslibs_time::Time(ros::Time::now().toNSec())));
-                    data_received_(odometry);
-                } else
-                    initialized_ = true;
-                o_T_b1_ = o_T_b2;
-            }
-            rate_.sleep();
+        using clock_t = common::Executor::clock_t;
+        const clock_t::time_point now = clock_t::now();
+        if (!poll_pending_) {
+            stats_.jitter.record(now - due);
+            poll_pending_  = true;
+            poll_tick_     = due;
+            poll_stamp_    = ros::Time::now();
+            poll_deadline_ = now + std::chrono::duration_cast<clock_t::duration>(
+                                 std::chrono::nanoseconds(tf_timeout_.toNSec()));
+        }
+
+        /// do not block the executor, retry until the transform arrived instead
+        stamped_t o_T_b2(cslibs_math_2d::Transform2<T>(), cslibs_time::Time(poll_stamp_.toNSec()).time());
+        const bool found = lookup(poll_stamp_, o_T_b2, ros::Duration(0.0));
+        if (!found && now < poll_deadline_) {
+            due = now + poll_retry_period_;
+            return true;
         }
-        running_ = false;
+
+        if (found)
+            update(o_T_b2);
+        else
+            ++stats_.failed_tf;
+        poll_pending_ = false;
+        due = std::max(poll_tick_ + poll_period_, now);
+        return true;
+    }
+
+    void tfCallback(const tf2_msgs::TFMessageConstPtr &msg)
+    {
+        /// find the newest stamp of a transform which is part of the odometry chain
+        ros::Time stamp;
+        for (const auto &t : msg->transforms) {
+            if (normalize(t.child_frame_id) == base_frame_id_ || normalize(t.header.frame_id) == odom_frame_id_)
+                stamp = std::max(stamp, t.header.stamp);
+        }
+        if (stamp.isZero() || stamp <= last_update_)
+            return;
+
+        recordReceived(stamp);
+        stamped_t o_T_b2(cslibs_math_2d::Transform2<T>(), cslibs_time::Time(stamp.toNSec()).time());
+        if (lookup(stamp, o_T_b2, tf_timeout_)) {
+            const cslibs_math_2d::Transform2<T> delta = o_T_b1_.data().inverse() * o_T_b2.data();
+            const bool stationary = delta.translation().length() < stationary_linear_ &&
+                                    std::abs(delta.yaw()) < stationary_angular_;
+            if (initialized_ && stationary && stamp < last_update_ + stationary_period_) {
+                ++stats_.throttled;
+                return;
+            }
+
+            update(o_T_b2);
+            last_update_ = stamp;
+        } else
+            ++stats_.failed_tf;
     }
 
-    virtual inline void doSetup(ros::NodeHandle &nh) override
+    bool lookup(const ros::Time &stamp, stamped_t &o_T_b2, const ros::Duration &timeout)
+    {
+        stats_t::ScopedTimer timer(stats_.tf_wait);
+        return tf_->lookupTransform(odom_frame_, base_frame_, stamp, o_T_b2, timeout);
+    }
+
+    void update(const stamped_t &o_T_b2)
+    {
+        if (initialized_) {
+            cslibs_time::TimeFrame time_frame(o_T_b1_.stamp(), o_T_b2.stamp());
+            typename types::Odometry2<T>::Ptr odometry(new types::Odometry2<T>(odom_frame_,
+                                                                               time_frame,
+                                                                               o_T_b1_.data(),
+                                                                               o_T_b2.data(),
+                                                                               cslibs_time::Time(ros::Time::now().toNSec())));
+            emit(odometry);
+        } else
+            initialized_ = true;
+        o_T_b1_ = o_T_b2;
+    }
+
+    inline static std::string normalize(const std::string &frame)
+    {
+        return !frame.empty() && frame.front() == '/' ? frame.substr(1) : frame;
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual inline void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
     {
         auto param_name = [this](const std::string &name){return name_ + "/" + name;};
 
-        odom_frame_ = nh.param<std::string>(param_name("odom_frame"), "/odom");
-        base_frame_ = nh.param<std::string>(param_name("base_frame"), "/base_link");
-        rate_       = ros::Rate(nh.param<double>(param_name("rate"), 70.0));
+        odom_frame_ = private_nh.param<std::string>(param_name("odom_frame"), "/odom");
+        base_frame_ = private_nh.param<std::string>(param_name("base_frame"), "/base_link");
+        rate_       = ros::Rate(private_nh.param<double>(param_name("rate"), 70.0));
+
+        event_driven_ = private_nh.param<bool>(param_name("event_driven"), false);
+        if (event_driven_) {
+            odom_frame_id_      = normalize(odom_frame_);
+            base_frame_id_      = normalize(base_frame_);
+            stationary_period_  = ros::Duration(1.0 / private_nh.param<double>(param_name("stationary_rate"), 5.0));
+            stationary_linear_  = static_cast<T>(private_nh.param<double>(param_name("stationary_linear_threshold"), 1e-4));
+            stationary_angular_ = static_cast<T>(private_nh.param<double>(param_name("stationary_angular_threshold"), 1e-4));
+
+            /// waiting for transforms must not block the shared callback queue
+            ros::NodeHandle tf_nh(nh);
+            tf_nh.setCallbackQueue(&tf_queue_);
+            tf_source_  = tf_nh.subscribe(private_nh.param<std::string>(param_name("tf_topic"), "/tf"), 100,
+                                          &Odometry2DProviderTFBase::tfCallback, this);
+            tf_spinner_.reset(new common::QueueSpinner(tf_queue_, 1, [this]() { applyThreadSettings(); }));
+            return;
+        }
 
-        if (!running_) {
-            /// fire up the thread
-            worker_thread_ = std::thread([this](){ loop();} );
+        if (!poll_task_) {
+            /// poll on an executor instead of a thread per provider
+            using clock_t = common::Executor::clock_t;
+            poll_period_       = std::chrono::duration_cast<clock_t::duration>(
+                                     std::chrono::nanoseconds(rate_.expectedCycleTime().toNSec()));
+            poll_retry_period_ = std::chrono::duration_cast<clock_t::duration>(
+                                     std::chrono::duration<double>(private_nh.param<double>(param_name("tf_retry_period"), 0.001)));
+            poll_task_ = executor()->scheduleRepeated([this](clock_t::time_point &due) {
+                return poll(due);
+            }, clock_t::now() + poll_period_);
         }
     }
 };
@@ -0,0 +1,5 @@
+#include "pointcloud_2d_slice_provider.h"
+
+#include <class_loader/register_macro.hpp>
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::Pointcloud2dSliceProvider_d, cslibs_plugins_data::DataProvider)
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::Pointcloud2dSliceProvider_f, cslibs_plugins_data::DataProvider)
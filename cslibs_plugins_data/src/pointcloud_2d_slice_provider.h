@@ -0,0 +1,150 @@
+#ifndef CSLIBS_PLUGINS_DATA_POINTCLOUD_2D_SLICE_PROVIDER_H
+#define CSLIBS_PLUGINS_DATA_POINTCLOUD_2D_SLICE_PROVIDER_H
+
+#include <sensor_msgs/PointCloud2.h>
+
+#include <cslibs_math_ros/sensor_msgs/conversion_3d.hpp>
+#include <cslibs_plugins_data/common/throttled_subscription.hpp>
+#include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/common/static_transform_cache.hpp>
+#include <cslibs_plugins_data/types/pointcloud_2d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_2d_convert.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
+
+namespace cslibs_plugins_data {
+template <typename T>
+class Pointcloud2dSliceProviderBase : public DataProvider
+{
+public:
+    Pointcloud2dSliceProviderBase() :
+        time_offset_(0.0),
+        time_of_last_measurement_(0.0),
+        min_chunk_size_(4096)
+    {
+    }
+    virtual ~Pointcloud2dSliceProviderBase()
+    {
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        source_.shutdown();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Pointcloud2<T>::staticType();
+    }
+
+protected:
+    ros::Subscriber source_;                    /// the subscriber to be used
+    std::string     topic_;                     /// topic to listen to
+    std::string     target_frame_;              /// frame the slice is taken in
+    common::StaticTransformCache<T> static_transforms_;  /// skips tf lookups for static chains
+
+    ros::Duration   time_offset_;
+    ros::Time       time_of_last_measurement_;
+
+    std::array<T, 2>range_limits_;              /// range limits in the sensor frame
+    std::array<T, 2>height_band_;               /// height band in the target frame
+
+    common::WorkerPool::Ptr             workers_;
+    std::size_t                         min_chunk_size_;
+
+    void callback(const sensor_msgs::PointCloud2ConstPtr &msg)
+    {
+        recordReceived(msg->header.stamp);
+        if (!time_offset_.isZero() && !time_of_last_measurement_.isZero())
+            if (msg->header.stamp <= (time_of_last_measurement_ + time_offset_)) {
+                ++stats_.throttled;
+                return;
+            }
+
+        cslibs_math_3d::Transform3<T> t_T_s;
+        bool found;
+        {
+            stats_t::ScopedTimer timer(stats_.tf_wait);
+            found = static_transforms_.lookup(*tf_, target_frame_, msg->header.frame_id, msg->header.stamp, t_T_s, tf_timeout_);
+        }
+        if (!found) {
+            ++stats_.failed_tf;
+            return;
+        }
+
+        typename types::Pointcloud2<T>::Ptr pointcloud(new types::Pointcloud2<T>(target_frame_,
+                                                                                   cslibs_math_ros::sensor_msgs::conversion_3d::from(msg),
+                                                                                   cslibs_time::Time(std::max(msg->header.stamp.toNSec(), ros::Time::now().toNSec()))));
+        try {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            types::slice(typename types::Pointcloud3View<T>(msg, range_limits_), t_T_s, height_band_, workers_.get(), pointcloud->points(),
+                         min_chunk_size_);
+        } catch (const std::exception &e) {
+            ROS_ERROR_STREAM(name_ << ": " << e.what());
+            return;
+        }
+        emit(pointcloud);
+
+        time_of_last_measurement_ = msg->header.stamp;
+    }
+
+    void throttledCallback(const common::ThrottledMessage<sensor_msgs::PointCloud2>::ConstPtr &msg)
+    {
+        if (!msg->msg) {
+            recordReceived(msg->stamp);
+            ++stats_.throttled;
+            return;
+        }
+        callback(msg->msg);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
+    {
+        auto param_name = [this](const std::string &name){return name_ + "/" + name;};
+
+        int queue_size  = private_nh.param<int>(param_name("queue_size"), 1);
+        topic_          = private_nh.param<std::string>(param_name("topic"), "");
+        target_frame_   = private_nh.param<std::string>(param_name("target_frame"), "base_link");
+        static_transforms_.setup(private_nh.param<bool>(param_name("static_transform"), false),
+                                 private_nh.param<bool>(param_name("detect_static_transforms"), true));
+
+        range_limits_   = {static_cast<T>(private_nh.param<double>(param_name("range_min"), 0.0)),
+                           static_cast<T>(private_nh.param<double>(param_name("range_max"), std::numeric_limits<T>::max()))};
+        height_band_    = {static_cast<T>(private_nh.param<double>(param_name("z_min"), -std::numeric_limits<T>::max())),
+                           static_cast<T>(private_nh.param<double>(param_name("z_max"), std::numeric_limits<T>::max()))};
+
+        const int threads = private_nh.param<int>(param_name("threads"), 1);
+        min_chunk_size_   = static_cast<std::size_t>(std::max(1, private_nh.param<int>(param_name("min_chunk_size"), 4096)));
+        if (threads > 1) {
+            /// by default share the process wide pool, at most threads may work on one message
+            workers_ = private_nh.param<bool>(param_name("shared_workers"), true) ?
+                        common::WorkerPool::limit(common::WorkerPool::shared(), static_cast<std::size_t>(threads)) :
+                        common::WorkerPool::Ptr(new common::WorkerPool(static_cast<std::size_t>(threads - 1),
+                                                                        [this]() { applyThreadSettings(); }));
+        }
+
+        double rate     = private_nh.param<double>(param_name("rate"), 0.0);
+        if (rate > 0.0) {
+            time_offset_ = ros::Duration(1.0 / rate);
+            ROS_INFO_STREAM(name_ << ": Throttling pointcloud slice to rate of " << rate << "Hz!");
+        }
+
+        if (!time_offset_.isZero() && throttleSerialized(private_nh)) {
+            /// drop messages before they are deserialized
+            using throttled_t = common::ThrottledMessage<sensor_msgs::PointCloud2>;
+            common::RateGate::Ptr gate(new common::RateGate(time_offset_));
+            source_ = common::subscribeThrottled<sensor_msgs::PointCloud2>(nh, topic_, static_cast<uint32_t>(queue_size), gate,
+                                                                           [this](const throttled_t::ConstPtr &msg) { throttledCallback(msg); });
+        } else {
+            source_ = nh.subscribe(topic_, queue_size, &Pointcloud2dSliceProviderBase::callback, this);
+        }
+    }
+};
+
+using Pointcloud2dSliceProvider_d = Pointcloud2dSliceProviderBase<double>;
+using Pointcloud2dSliceProvider_f = Pointcloud2dSliceProviderBase<float>;
+}
+
+#endif // CSLIBS_PLUGINS_DATA_POINTCLOUD_2D_SLICE_PROVIDER_H
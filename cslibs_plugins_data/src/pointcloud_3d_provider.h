@@ -3,8 +3,13 @@
 
 #include <sensor_msgs/PointCloud2.h>
 
+#include <cslibs_plugins_data/common/throttled_subscription.hpp>
 #include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/common/static_transform_cache.hpp>
 #include <cslibs_plugins_data/types/pointcloud_3d.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_convert.hpp>
+#include <cslibs_plugins_data/types/pointcloud_3d_voxel_grid.hpp>
+#include <cslibs_plugins_data/common/worker_pool.hpp>
 
 namespace cslibs_plugins_data {
 template <typename T>
@@ -13,10 +18,24 @@ class Pointcloud3dProviderBase : public DataProvider
 public:
     Pointcloud3dProviderBase() :
         time_offset_(0.0),
-        time_of_last_measurement_(0.0)
+        time_of_last_measurement_(0.0),
+        zero_copy_(false),
+        transform_(false),
+        organized_(false),
+        min_chunk_size_(4096)
     {
     }
-    virtual ~Pointcloud3dProviderBase() = default;
+    virtual ~Pointcloud3dProviderBase()
+    {
+        /// wait for running callbacks before members are destroyed
+        DataProvider::shutdown();
+        source_.shutdown();
+    }
+
+    virtual DataType outputType() const override
+    {
+        return types::Pointcloud3<T>::staticType();
+    }
 
 protected:
     ros::Subscriber source_;                    /// the subscriber to be used
@@ -26,39 +45,163 @@ protected:
     ros::Time       time_of_last_measurement_;
 
     std::array<T, 2>range_limits_;
+    bool            zero_copy_;                 /// wrap the message instead of converting it
+
+    bool            transform_;                 /// transform the points into another frame
+    std::string     transform_to_frame_;
+    common::StaticTransformCache<T> static_transforms_;  /// skips tf lookups for static chains
+    bool            organized_;                 /// keep the organized layout as range image
+
+    std::unique_ptr<types::VoxelGrid<T>>        voxel_grid_;    /// optional downsampling
+    common::WorkerPool::Ptr                     workers_;
+    std::size_t                                 min_chunk_size_;
 
     void callback(const sensor_msgs::PointCloud2ConstPtr &msg)
     {
+        recordReceived(msg->header.stamp);
         if (!time_offset_.isZero() && !time_of_last_measurement_.isZero())
-            if (msg->header.stamp <= (time_of_last_measurement_ + time_offset_))
+            if (msg->header.stamp <= (time_of_last_measurement_ + time_offset_)) {
+                ++stats_.throttled;
                 return;
+            }
 
-        typename types::Pointcloud3<T>::Ptr pointcloud(new types::Pointcloud3<T>(msg->header.frame_id,
+        using view_t = typename types::Pointcloud3<T>::view_t;
+
+        typename types::Pointcloud3<T>::Ptr pointcloud(new types::Pointcloud3<T>(transform_ ? transform_to_frame_ : msg->header.frame_id,
                                                                                    cslibs_math_ros::sensor_msgs::conversion_3d::from(msg),
                                                                                    cslibs_time::Time(std::max(msg->header.stamp.toNSec(), ros::Time::now().toNSec()))));
 
-        cslibs_math_ros::sensor_msgs::conversion_3d::from<T>(msg, pointcloud->points(), range_limits_);
-        data_received_(pointcloud);
+        cslibs_math_3d::Transform3<T> t_T_s;
+        if (transform_) {
+            bool found;
+            {
+                stats_t::ScopedTimer timer(stats_.tf_wait);
+                found = static_transforms_.lookup(*tf_, transform_to_frame_, msg->header.frame_id, msg->header.stamp, t_T_s, tf_timeout_);
+            }
+            if (!found) {
+                ++stats_.failed_tf;
+                return;
+            }
+        }
+
+        try {
+            stats_t::ScopedTimer timer(stats_.conversion);
+            if (zero_copy_) {
+                pointcloud->setView(typename view_t::ConstPtr(new view_t(msg, range_limits_)));
+            } else {
+                /// converted and range filtered in chunks, which keep the order of the message
+                const view_t view(msg, range_limits_);
+                typename types::Pointcloud3<T>::image_t::Ptr *image = organized_ && view.organized() ?
+                            &pointcloud->rangeImage() : nullptr;
+                if (transform_) {
+                    types::convert(view, t_T_s, workers_.get(), pointcloud->points(), min_chunk_size_, image);
+                } else {
+                    types::convert(view, workers_.get(), pointcloud->points(), min_chunk_size_, image);
+                }
+            }
+
+            if (voxel_grid_)
+                downsample(*pointcloud);
+        } catch (const std::exception &e) {
+            ROS_ERROR_STREAM(name_ << ": " << e.what());
+            return;
+        }
+
+        emit(pointcloud);
 
         time_of_last_measurement_ = msg->header.stamp;
     }
 
+    void downsample(types::Pointcloud3<T> &pointcloud)
+    {
+        typename types::Pointcloud3<T>::cloud_t::Ptr downsampled;
+        if (pointcloud.hasView()) {
+            const auto &view = *pointcloud.view();
+            const auto &mask = view.mask();
+            voxel_grid_->apply(view.size(),
+                               [&view](const std::size_t i) { return view.point(i); },
+                               [&mask](const std::size_t i) { return mask[i] != 0; },
+                               workers_.get(), downsampled);
+            /// the view still exposes every point, consumers only get the downsampled ones
+            pointcloud.setView(typename types::Pointcloud3<T>::view_t::ConstPtr());
+        } else {
+            voxel_grid_->apply(*pointcloud.points(), workers_.get(), downsampled);
+        }
+        pointcloud.points() = downsampled;
+    }
+
+    void throttledCallback(const common::ThrottledMessage<sensor_msgs::PointCloud2>::ConstPtr &msg)
+    {
+        if (!msg->msg) {
+            recordReceived(msg->stamp);
+            ++stats_.throttled;
+            return;
+        }
+        callback(msg->msg);
+    }
+
     virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
     {
         auto param_name = [this](const std::string &name){return name_ + "/" + name;};
 
-        int queue_size  = nh.param<int>(param_name("queue_size"), 1);
-        topic_          = nh.param<std::string>(param_name("topic"), "");
-        source_         = nh.subscribe(topic_, queue_size, &Pointcloud3dProviderBase::callback, this);
+        int queue_size  = private_nh.param<int>(param_name("queue_size"), 1);
+        topic_          = private_nh.param<std::string>(param_name("topic"), "");
+
+        range_limits_   = {static_cast<T>(private_nh.param<double>(param_name("range_min"), 0.0)),
+                           static_cast<T>(private_nh.param<double>(param_name("range_max"), std::numeric_limits<T>::max()))};
 
-        range_limits_   = {static_cast<T>(nh.param<double>(param_name("range_min"), 0.0)),
-                           static_cast<T>(nh.param<double>(param_name("range_max"), std::numeric_limits<double>::max()))};
+        zero_copy_      = private_nh.param<bool>(param_name("zero_copy"), false);
 
-        double rate     = nh.param<double>(param_name("rate"), 0.0);
+        transform_          = private_nh.param<bool>(param_name("transform"), false);
+        transform_to_frame_ = private_nh.param<std::string>(param_name("transform_to_frame"), "base_link");
+        if (transform_)
+            static_transforms_.setup(private_nh.param<bool>(param_name("static_transform"), false),
+                                     private_nh.param<bool>(param_name("detect_static_transforms"), true));
+        organized_          = private_nh.param<bool>(param_name("organized"), false);
+        if ((transform_ || organized_) && zero_copy_) {
+            zero_copy_ = false;
+            ROS_WARN_STREAM(name_ << ": Transforming and keeping the organized layout require conversion, disabling zero copy!");
+        }
+
+        const int threads = private_nh.param<int>(param_name("threads"), 1);
+        min_chunk_size_   = static_cast<std::size_t>(std::max(1, private_nh.param<int>(param_name("min_chunk_size"), 4096)));
+        if (threads > 1) {
+            /// by default share the process wide pool, at most threads may work on one message
+            workers_ = private_nh.param<bool>(param_name("shared_workers"), true) ?
+                        common::WorkerPool::limit(common::WorkerPool::shared(), static_cast<std::size_t>(threads)) :
+                        common::WorkerPool::Ptr(new common::WorkerPool(static_cast<std::size_t>(threads - 1),
+                                                                        [this]() { applyThreadSettings(); }));
+        }
+
+        const double leaf_size = private_nh.param<double>(param_name("voxel_leaf_size"), 0.0);
+        if (leaf_size > 0.0) {
+            voxel_grid_.reset(new types::VoxelGrid<T>(static_cast<T>(leaf_size),
+                                                      types::VoxelGrid<T>::policyFromString(
+                                                          private_nh.param<std::string>(param_name("voxel_policy"), "centroid")),
+                                                      min_chunk_size_));
+            ROS_INFO_STREAM(name_ << ": Downsampling pointcloud with leaf size of " << leaf_size << "m!");
+        }
+
+        double rate     = private_nh.param<double>(param_name("rate"), 0.0);
         if (rate > 0.0) {
             time_offset_ = ros::Duration(1.0 / rate);
             ROS_INFO_STREAM(name_ << ": Throttling pointcloud to rate of " << rate << "Hz!");
         }
+
+        if (!time_offset_.isZero() && throttleSerialized(private_nh)) {
+            /// drop messages before they are deserialized
+            using throttled_t = common::ThrottledMessage<sensor_msgs::PointCloud2>;
+            common::RateGate::Ptr gate(new common::RateGate(time_offset_));
+            source_ = common::subscribeThrottled<sensor_msgs::PointCloud2>(nh, topic_, static_cast<uint32_t>(queue_size), gate,
+                                                                           [this](const throttled_t::ConstPtr &msg) { throttledCallback(msg); });
+        } else {
+            source_ = nh.subscribe(topic_, queue_size, &Pointcloud3dProviderBase::callback, this);
+        }
     }
 };
 
@@ -0,0 +1,243 @@
+#include <cslibs_plugins_data/recording/log_reader.hpp>
+
+#ifdef CSLIBS_PLUGINS_DATA_WITH_LZ4
+#include <lz4.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace cslibs_plugins_data {
+namespace recording {
+LogReader::LogReader(const std::string &path) :
+    fd_(::open(path.c_str(), O_RDONLY)),
+    map_(nullptr),
+    size_(0),
+    chunk_(0),
+    record_(0),
+    offset_(0),
+    payload_(nullptr),
+    payload_size_(0)
+{
+    if (fd_ < 0)
+        throw std::runtime_error("[LogReader]: Cannot open '" + path + "'!");
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd_);
+        throw std::runtime_error("[LogReader]: '" + path + "' is not a data log!");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+
+    void *map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("[LogReader]: Cannot map '" + path + "'!");
+    }
+    map_ = static_cast<const uint8_t*>(map);
+    ::madvise(map, size_, MADV_SEQUENTIAL);
+
+    FileHeader header;
+    std::memcpy(&header, map_, sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+        ::munmap(map, size_);
+        ::close(fd_);
+        throw std::runtime_error("[LogReader]: '" + path + "' is not a data log of version " + std::to_string(VERSION) + "!");
+    }
+
+    buildIndex();
+    rewind();
+}
+
+LogReader::~LogReader()
+{
+    storage_.reset();
+    ::munmap(const_cast<uint8_t*>(map_), size_);
+    ::close(fd_);
+}
+
+std::size_t LogReader::records() const
+{
+    std::size_t n = 0;
+    for (const auto &e : index_)
+        n += e.records;
+    return n;
+}
+
+int64_t LogReader::startStamp() const
+{
+    int64_t stamp = index_.empty() ? 0 : std::numeric_limits<int64_t>::max();
+    for (const auto &e : index_)
+        stamp = std::min(stamp, e.stamp_min);
+    return stamp;
+}
+
+int64_t LogReader::endStamp() const
+{
+    int64_t stamp = index_.empty() ? 0 : std::numeric_limits<int64_t>::min();
+    for (const auto &e : index_)
+        stamp = std::max(stamp, e.stamp_max);
+    return stamp;
+}
+
+void LogReader::rewind()
+{
+    chunk_        = 0;
+    record_       = 0;
+    offset_       = 0;
+    payload_      = nullptr;
+    payload_size_ = 0;
+    storage_.reset();
+    if (!index_.empty())
+        loadChunk(0);
+}
+
+void LogReader::seek(const int64_t stamp)
+{
+    /// records of several providers are not strictly ordered by their received
+    /// stamps, neither are the chunks, the first one reaching the stamp is used
+    auto it = std::find_if(index_.begin(), index_.end(),
+                           [stamp](const IndexEntry &e) { return e.stamp_max >= stamp; });
+    chunk_ = static_cast<std::size_t>(std::distance(index_.begin(), it));
+    if (chunk_ >= index_.size() || !loadChunk(chunk_))
+        return;
+
+    Record record;
+    while (record_ < index_[chunk_].records) {
+        const std::size_t offset = offset_;
+        const std::size_t index  = record_;
+        if (!next(record))
+            return;
+        if (record.header.received >= stamp) {
+            offset_ = offset;
+            record_ = index;
+            return;
+        }
+    }
+}
+
+bool LogReader::next(Record &record)
+{
+    while (chunk_ < index_.size()) {
+        if (payload_ && record_ < index_[chunk_].records &&
+                offset_ + sizeof(RecordHeader) <= payload_size_) {
+            std::memcpy(&record.header, payload_ + offset_, sizeof(RecordHeader));
+            const std::size_t frame   = offset_ + sizeof(RecordHeader);
+            const std::size_t payload = frame + record.header.frame_size;
+            const std::size_t end     = payload + record.header.payload_size;
+            if (end > payload_size_)
+                throw std::runtime_error("[LogReader]: Record exceeds its chunk, the log is corrupt!");
+
+            record.frame   = reinterpret_cast<const char*>(payload_ + frame);
+            record.payload = payload_ + payload;
+            record.storage = storage_;
+            offset_ = end;
+            ++record_;
+            return true;
+        }
+        if (++chunk_ < index_.size())
+            loadChunk(chunk_);
+    }
+    return false;
+}
+
+bool LogReader::next(Data::ConstPtr &data)
+{
+    Record record;
+    while (next(record)) {
+        data = decode(record);
+        if (data)
+            return true;
+    }
+    return false;
+}
+
+void LogReader::buildIndex()
+{
+    index_.clear();
+
+    /// a complete log carries an index at its end
+    if (size_ >= sizeof(FileHeader) + sizeof(IndexHeader) + sizeof(Footer)) {
+        Footer footer;
+        std::memcpy(&footer, map_ + size_ - sizeof(Footer), sizeof(Footer));
+        if (std::memcmp(footer.magic, FOOTER_MAGIC, sizeof(footer.magic)) == 0 &&
+                footer.index_offset + sizeof(IndexHeader) <= size_ - sizeof(Footer)) {
+            IndexHeader header;
+            std::memcpy(&header, map_ + footer.index_offset, sizeof(header));
+            const std::size_t entries = footer.index_offset + sizeof(IndexHeader);
+            if (header.magic == INDEX_MAGIC &&
+                    entries + header.count * sizeof(IndexEntry) <= size_ - sizeof(Footer)) {
+                index_.resize(header.count);
+                if (header.count > 0)
+                    std::memcpy(index_.data(), map_ + entries, header.count * sizeof(IndexEntry));
+                return;
+            }
+        }
+    }
+
+    /// otherwise recover all complete chunks
+    std::size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(ChunkHeader) <= size_) {
+        ChunkHeader header;
+        std::memcpy(&header, map_ + offset, sizeof(header));
+        if (header.magic != CHUNK_MAGIC || offset + sizeof(ChunkHeader) + header.stored_size > size_)
+            break;
+
+        IndexEntry entry;
+        entry.offset    = offset;
+        entry.stamp_min = header.stamp_min;
+        entry.stamp_max = header.stamp_max;
+        entry.records   = header.records;
+        entry.reserved  = 0;
+        index_.emplace_back(entry);
+        offset += sizeof(ChunkHeader) + header.stored_size;
+    }
+}
+
+bool LogReader::loadChunk(const std::size_t chunk)
+{
+    record_       = 0;
+    offset_       = 0;
+    payload_      = nullptr;
+    payload_size_ = 0;
+    storage_.reset();
+
+    const IndexEntry &entry = index_[chunk];
+    if (entry.offset + sizeof(ChunkHeader) > size_)
+        return false;
+
+    ChunkHeader header;
+    std::memcpy(&header, map_ + entry.offset, sizeof(header));
+    if (header.magic != CHUNK_MAGIC || entry.offset + sizeof(ChunkHeader) + header.stored_size > size_)
+        return false;
+
+    const uint8_t *stored = map_ + entry.offset + sizeof(ChunkHeader);
+    if ((header.flags & CHUNK_FLAG_LZ4) == 0) {
+        payload_      = stored;
+        payload_size_ = header.stored_size;
+        return true;
+    }
+
+#ifdef CSLIBS_PLUGINS_DATA_WITH_LZ4
+    std::shared_ptr<std::vector<uint8_t>> buffer(new std::vector<uint8_t>(header.raw_size));
+    const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(stored), reinterpret_cast<char*>(buffer->data()),
+                                         static_cast<int>(header.stored_size), static_cast<int>(header.raw_size));
+    if (size < 0 || static_cast<uint64_t>(size) != header.raw_size)
+        throw std::runtime_error("[LogReader]: Decompressing chunk " + std::to_string(chunk) + " failed!");
+    payload_      = buffer->data();
+    payload_size_ = buffer->size();
+    storage_      = buffer;
+    return true;
+#else
+    throw std::runtime_error("[LogReader]: Log is compressed, but LZ4 support is not available!");
+#endif
+}
+}
+}
@@ -0,0 +1,232 @@
+#include <cslibs_plugins_data/recording/log_writer.hpp>
+#include <cslibs_plugins_data/recording/serialization.hpp>
+
+#ifdef CSLIBS_PLUGINS_DATA_WITH_LZ4
+#include <lz4.h>
+#endif
+
+#include <ros/console.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace cslibs_plugins_data {
+namespace recording {
+LogWriter::LogWriter(const std::string &path,
+                     const Options     &options) :
+    options_(options),
+    file_(nullptr),
+    failed_(false),
+    skipped_(0),
+    chunk_records_(0),
+    chunk_stamp_min_(std::numeric_limits<int64_t>::max()),
+    chunk_stamp_max_(std::numeric_limits<int64_t>::min())
+{
+#ifndef CSLIBS_PLUGINS_DATA_WITH_LZ4
+    options_.compress = false;
+#endif
+    chunk_.reserve(options_.chunk_size);
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        throw std::runtime_error("[LogWriter]: Cannot open '" + path + "' for writing!");
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.flags   = 0;
+    if (std::fwrite(&header, 1, sizeof(header), file_) != sizeof(header)) {
+        std::fclose(file_);
+        throw std::runtime_error("[LogWriter]: Cannot write to '" + path + "'!");
+    }
+}
+
+LogWriter::LogWriter(const std::string &path) :
+    LogWriter(path, Options())
+{
+}
+
+LogWriter::~LogWriter()
+{
+    close();
+}
+
+bool LogWriter::write(const Data &data)
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    if (!file_)
+        return false;
+
+    /// a truncated frame name would silently alias another frame on replay
+    const std::string &frame = data.frame();
+    if (frame.size() > std::numeric_limits<uint16_t>::max()) {
+        ++skipped_;
+        ROS_ERROR_STREAM("[LogWriter]: Frame name of " << frame.size() << " bytes exceeds "
+                         << std::numeric_limits<uint16_t>::max() << " bytes, record skipped!");
+        return false;
+    }
+
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    payload_.clear();
+    if (!encode(data, header, payload_))
+        return false;
+
+    header.frame_size   = static_cast<uint16_t>(frame.size());
+    header.payload_size = static_cast<uint32_t>(payload_.size());
+
+    const std::size_t pos = chunk_.size();
+    chunk_.resize(pos + sizeof(header) + header.frame_size + payload_.size());
+    uint8_t *dst = chunk_.data() + pos;
+    std::memcpy(dst, &header, sizeof(header));
+    std::memcpy(dst + sizeof(header), frame.data(), header.frame_size);
+    if (!payload_.empty())
+        std::memcpy(dst + sizeof(header) + header.frame_size, payload_.data(), payload_.size());
+
+    ++chunk_records_;
+    chunk_stamp_min_ = std::min(chunk_stamp_min_, header.received);
+    chunk_stamp_max_ = std::max(chunk_stamp_max_, header.received);
+
+    if (chunk_.size() >= options_.chunk_size)
+        return writeChunk();
+    return true;
+}
+
+void LogWriter::flush()
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    if (!file_ || !writeChunk())
+        return;
+    if (std::fflush(file_) != 0)
+        fail();
+}
+
+void LogWriter::close()
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    if (!file_ || !writeChunk())
+        return;
+
+    Footer footer;
+    footer.index_offset = static_cast<uint64_t>(std::ftell(file_));
+    std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(footer.magic));
+
+    IndexHeader index;
+    index.magic    = INDEX_MAGIC;
+    index.reserved = 0;
+    index.count    = index_.size();
+    if (!writeBytes(&index, sizeof(index)) ||
+            (!index_.empty() && !writeBytes(index_.data(), index_.size() * sizeof(IndexEntry))) ||
+            !writeBytes(&footer, sizeof(footer)))
+        return;
+
+    const bool closed = std::fclose(file_) == 0;
+    file_ = nullptr;
+    if (!closed) {
+        failed_ = true;
+        ROS_ERROR_STREAM("[LogWriter]: Closing the log failed: " << std::strerror(errno));
+    }
+}
+
+bool LogWriter::failed() const
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    return failed_;
+}
+
+std::size_t LogWriter::skipped() const
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    return skipped_;
+}
+
+DataProvider::async_connection_t::Ptr LogWriter::attach(DataProvider &provider,
+                                                        const DataProvider::async_connection_t::Options &options)
+{
+    return provider.connect(DataProvider::callback_t([this](const Data::ConstPtr &data) {
+                                if (data)
+                                    write(*data);
+                            }),
+                            options);
+}
+
+DataProvider::async_connection_t::Options LogWriter::defaultQueueOptions()
+{
+    DataProvider::async_connection_t::Options options;
+    options.queue_size = 256;
+    options.policy     = DataProvider::async_connection_t::OverflowPolicy::DROP_OLDEST;
+    return options;
+}
+
+bool LogWriter::writeChunk()
+{
+    if (chunk_records_ == 0)
+        return true;
+
+    ChunkHeader header;
+    header.magic       = CHUNK_MAGIC;
+    header.flags       = 0;
+    header.raw_size    = chunk_.size();
+    header.stored_size = chunk_.size();
+    header.records     = chunk_records_;
+    header.reserved    = 0;
+    header.stamp_min   = chunk_stamp_min_;
+    header.stamp_max   = chunk_stamp_max_;
+
+    const uint8_t *stored = chunk_.data();
+#ifdef CSLIBS_PLUGINS_DATA_WITH_LZ4
+    std::vector<char> compressed;
+    if (options_.compress && chunk_.size() <= static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+        compressed.resize(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(chunk_.size()))));
+        const int size = LZ4_compress_default(reinterpret_cast<const char*>(chunk_.data()), compressed.data(),
+                                              static_cast<int>(chunk_.size()), static_cast<int>(compressed.size()));
+        /// incompressible chunks are stored as they are
+        if (size > 0 && static_cast<std::size_t>(size) < chunk_.size()) {
+            header.flags      |= CHUNK_FLAG_LZ4;
+            header.stored_size = static_cast<uint64_t>(size);
+            stored             = reinterpret_cast<const uint8_t*>(compressed.data());
+        }
+    }
+#endif
+
+    IndexEntry entry;
+    entry.offset    = static_cast<uint64_t>(std::ftell(file_));
+    entry.stamp_min = chunk_stamp_min_;
+    entry.stamp_max = chunk_stamp_max_;
+    entry.records   = chunk_records_;
+    entry.reserved  = 0;
+    index_.emplace_back(entry);
+
+    if (!writeBytes(&header, sizeof(header)) || !writeBytes(stored, header.stored_size))
+        return false;
+
+    chunk_.clear();
+    chunk_records_   = 0;
+    chunk_stamp_min_ = std::numeric_limits<int64_t>::max();
+    chunk_stamp_max_ = std::numeric_limits<int64_t>::min();
+    return true;
+}
+
+bool LogWriter::writeBytes(const void *data, const std::size_t size)
+{
+    if (std::fwrite(data, 1, size, file_) == size)
+        return true;
+    fail();
+    return false;
+}
+
+void LogWriter::fail()
+{
+    ROS_ERROR_STREAM("[LogWriter]: Writing to log failed, recording stopped: " << std::strerror(errno));
+    std::fclose(file_);
+    file_   = nullptr;
+    failed_ = true;
+    index_.clear();
+    chunk_.clear();
+    chunk_records_ = 0;
+}
+}
+}
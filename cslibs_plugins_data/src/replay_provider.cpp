@@ -0,0 +1,4 @@
+#include "replay_provider.h"
+
+#include <class_loader/register_macro.hpp>
+CLASS_LOADER_REGISTER_CLASS(cslibs_plugins_data::ReplayProvider, cslibs_plugins_data::DataProvider)
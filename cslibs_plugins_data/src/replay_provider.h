@@ -0,0 +1,236 @@
+#ifndef CSLIBS_PLUGINS_DATA_REPLAY_PROVIDER_H
+#define CSLIBS_PLUGINS_DATA_REPLAY_PROVIDER_H
+
+#include <ros/ros.h>
+#include <rosgraph_msgs/Clock.h>
+
+#include <cslibs_plugins_data/common/executor.hpp>
+#include <cslibs_plugins_data/data_provider.hpp>
+#include <cslibs_plugins_data/recording/log_reader.hpp>
+
+#include <atomic>
+#include <chrono>
+
+namespace cslibs_plugins_data {
+/**
+ * @brief The ReplayProvider class streams data from a log recorded with
+ *        recording::LogWriter. Data keeps its original time frame and received
+ *        stamp, pacing follows the received stamps scaled by the replay rate.
+ *        Data is emitted from a thread of the provider's own, since consumers
+ *        run on it and would otherwise hold up the shared executor.
+ */
+class ReplayProvider : public DataProvider
+{
+public:
+    ReplayProvider() :
+        rate_(1.0),
+        loop_(false),
+        start_offset_(0),
+        start_delay_(0.0),
+        sim_time_(0),
+        replayed_(0),
+        running_(false),
+        first_(true),
+        log_start_(0)
+    {
+    }
+
+    virtual ~ReplayProvider()
+    {
+        DataProvider::shutdown();
+        stop();
+    }
+
+    /**
+     * @brief Start replaying from the beginning of the log.
+     */
+    void start()
+    {
+        stop();
+        if (!reader_)
+            return;
+
+        rewind();
+
+        if (!replay_executor_)
+            replay_executor_ = std::make_shared<common::Executor>(1, [this]() { applyThreadSettings(); });
+        next_.reset();
+        first_    = true;
+        running_  = true;
+        task_     = replay_executor_->scheduleRepeated([this](clock_t::time_point &next) { return step(next); },
+                                                clock_t::now() + std::chrono::duration_cast<clock_t::duration>(
+                                                    std::chrono::duration<double>(start_delay_)));
+    }
+
+    /**
+     * @brief Stop replaying, blocks until the data currently emitted is handled.
+     */
+    void stop()
+    {
+        if (task_) {
+            task_->cancel();
+            task_.reset();
+        }
+        running_ = false;
+    }
+
+    /**
+     * @brief True while data is replayed.
+     */
+    inline bool running() const
+    {
+        return running_;
+    }
+
+    /**
+     * @brief Received stamp of the data emitted last, i.e. the simulated time.
+     */
+    inline cslibs_time::Time simTime() const
+    {
+        return cslibs_time::Time(sim_time_.load());
+    }
+
+    /**
+     * @brief Amount of data emitted since the replay was started.
+     */
+    inline std::size_t replayed() const
+    {
+        return replayed_;
+    }
+
+protected:
+    using clock_t = common::Executor::clock_t;
+
+    recording::LogReader::Ptr reader_;
+    std::string               path_;
+    double                    rate_;                /// replay speed factor, 0 replays as fast as possible
+    bool                      loop_;
+    int64_t                   start_offset_;        /// ns into the log to start at
+    double                    start_delay_;         /// s to wait for consumers to connect
+
+    ros::Publisher            clock_pub_;           /// optional simulated clock for sim time consumers
+
+    std::atomic<int64_t>      sim_time_;
+    std::atomic<std::size_t>  replayed_;
+    std::atomic_bool          running_;
+
+    common::Executor::Ptr     replay_executor_;     /// emits the replayed data
+    common::Executor::Task::Ptr task_;
+    Data::ConstPtr            next_;                /// read but not yet due
+    bool                      first_;
+    int64_t                   log_start_;
+    clock_t::time_point       wall_start_;
+
+    /**
+     * @brief Emit the data which is due and set the due time of the next one.
+     * @return false at the end of the log
+     */
+    bool step(clock_t::time_point &next)
+    {
+        /// return regularly when replaying as fast as possible, so stopping is not held up
+        const std::size_t batch = 64;
+        for (std::size_t i = 0; i < batch; ++i) {
+            if (!next_ && !read(next_)) {
+                running_ = false;
+                return false;
+            }
+
+            const int64_t stamp = static_cast<int64_t>(next_->stampReceived().nanoseconds());
+            if (first_) {
+                log_start_  = stamp;
+                wall_start_ = clock_t::now();
+                first_      = false;
+            }
+
+            if (rate_ > 0.0) {
+                const auto due = wall_start_ + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(stamp - log_start_) / rate_));
+                const auto now = clock_t::now();
+                if (due > now) {
+                    next = due;
+                    return true;
+                }
+                stats_.jitter.record(now - due);
+            }
+
+            sim_time_ = stamp;
+            if (clock_pub_) {
+                rosgraph_msgs::Clock clock;
+                clock.clock.fromNSec(static_cast<uint64_t>(stamp));
+                clock_pub_.publish(clock);
+            }
+            emit(next_);
+            next_.reset();
+            ++replayed_;
+        }
+        next = clock_t::now();
+        return true;
+    }
+
+    /**
+     * @brief Continue reading at the start of the log, skipping start_offset.
+     */
+    void rewind()
+    {
+        reader_->rewind();
+        if (start_offset_ > 0)
+            reader_->seek(reader_->startStamp() + start_offset_);
+    }
+
+    bool read(Data::ConstPtr &data)
+    {
+        try {
+            if (reader_->next(data))
+                return true;
+            if (!loop_)
+                return false;
+            rewind();
+            first_ = true;
+            return reader_->next(data);
+        } catch (const std::exception &e) {
+            ROS_ERROR_STREAM(name_ << ": " << e.what());
+            return false;
+        }
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh) override
+    {
+        doSetup(nh, nh);
+    }
+
+    virtual void doSetup(ros::NodeHandle &nh, ros::NodeHandle &private_nh) override
+    {
+        auto param_name = [this](const std::string &name){return name_ + "/" + name;};
+
+        path_         = private_nh.param<std::string>(param_name("path"), "");
+        rate_         = std::max(0.0, private_nh.param<double>(param_name("rate"), 1.0));
+        loop_         = private_nh.param<bool>(param_name("loop"), false);
+        start_offset_ = static_cast<int64_t>(std::max(0.0, private_nh.param<double>(param_name("start_offset"), 0.0)) * 1e9);
+        start_delay_  = std::max(0.0, private_nh.param<double>(param_name("start_delay"), 1.0));
+
+        if (private_nh.param<bool>(param_name("publish_clock"), false))
+            clock_pub_ = nh.advertise<rosgraph_msgs::Clock>("/clock", 1);
+
+        if (path_.empty()) {
+            ROS_WARN_STREAM(name_ << ": No log given, nothing will be replayed.");
+            return;
+        }
+
+        try {
+            reader_.reset(new recording::LogReader(path_));
+        } catch (const std::exception &e) {
+            ROS_ERROR_STREAM(name_ << ": " << e.what());
+            return;
+        }
+
+        if (rate_ > 0.0)
+            ROS_INFO_STREAM(name_ << ": Replaying " << reader_->records() << " records from '" << path_ << "' at rate " << rate_ << ".");
+        else
+            ROS_INFO_STREAM(name_ << ": Replaying " << reader_->records() << " records from '" << path_ << "' as fast as possible.");
+
+        if (private_nh.param<bool>(param_name("autostart"), true))
+            start();
+    }
+};
+}
+
+#endif // CSLIBS_PLUGINS_DATA_REPLAY_PROVIDER_H
@@ -31,7 +31,14 @@ TEST(Test_cslibs_plugins_data, testLoadProviders) {
       "cslibs_plugins_data::Odometry2DProvider_f",
       "cslibs_plugins_data::Odometry2DProviderTF",
       "cslibs_plugins_data::Odometry2DProviderTF_d",
-      "cslibs_plugins_data::Odometry2DProviderTF_f"};
+      "cslibs_plugins_data::Odometry2DProviderTF_f",
+      "cslibs_plugins_data::Pointcloud2dSliceProvider_d",
+      "cslibs_plugins_data::Pointcloud2dSliceProvider_f",
+      "cslibs_plugins_data::ReplayProvider",
+      "cslibs_plugins_data::MultiEchoLaserProvider_d",
+      "cslibs_plugins_data::MultiEchoLaserProvider_f",
+      "cslibs_plugins_data::MergedLaserProvider_d",
+      "cslibs_plugins_data::MergedLaserProvider_f"};
 
   for (const auto &class_name : class_names) {
     auto constructor = manager.getConstructor(class_name);
@@ -84,6 +91,26 @@ TEST(Test_cslibs_plugins_data, testParseLaunchFile) {
   expected_plugins.emplace("cslibs_plugins_data::Pointcloud3dProvider_f",
                            "pointcloud_f");
   EXPECT_EQ(12ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::Pointcloud2dSliceProvider_d",
+                           "pointcloud_slice_d");
+  EXPECT_EQ(13ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::Pointcloud2dSliceProvider_f",
+                           "pointcloud_slice_f");
+  EXPECT_EQ(14ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::ReplayProvider", "replay");
+  EXPECT_EQ(15ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::MultiEchoLaserProvider_d",
+                           "multi_echo_laser_d");
+  EXPECT_EQ(16ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::MultiEchoLaserProvider_f",
+                           "multi_echo_laser_f");
+  EXPECT_EQ(17ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::MergedLaserProvider_d",
+                           "merged_laser_d");
+  EXPECT_EQ(18ul, expected_plugins.size());
+  expected_plugins.emplace("cslibs_plugins_data::MergedLaserProvider_f",
+                           "merged_laser_f");
+  EXPECT_EQ(19ul, expected_plugins.size());
 
   EXPECT_EQ(expected_plugins.size(), plugins.size());
   for (auto plugin : plugins) {
@@ -126,6 +153,21 @@ TEST(Test_cslibs_plugins_data, testPluginLoaderV2) {
   expected_plugins.emplace("cslibs_plugins_data::Pointcloud3dProvider_f",
                            "pointcloud_f");
 
+  expected_plugins.emplace("cslibs_plugins_data::Pointcloud2dSliceProvider_d",
+                           "pointcloud_slice_d");
+  expected_plugins.emplace("cslibs_plugins_data::Pointcloud2dSliceProvider_f",
+                           "pointcloud_slice_f");
+
+  expected_plugins.emplace("cslibs_plugins_data::ReplayProvider", "replay");
+
+  expected_plugins.emplace("cslibs_plugins_data::MultiEchoLaserProvider_d",
+                           "multi_echo_laser_d");
+  expected_plugins.emplace("cslibs_plugins_data::MultiEchoLaserProvider_f",
+                           "multi_echo_laser_f");
+  expected_plugins.emplace("cslibs_plugins_data::MergedLaserProvider_d",
+                           "merged_laser_d");
+  expected_plugins.emplace("cslibs_plugins_data::MergedLaserProvider_f",
+                           "merged_laser_f");
 
   for (auto plugin : plugins) {
     EXPECT_TRUE(expected_plugins.find(plugin) != expected_plugins.end());
@@ -133,7 +175,7 @@ TEST(Test_cslibs_plugins_data, testPluginLoaderV2) {
 
   std::map<std::string, cslibs_plugins_data::DataProvider::Ptr> loaded_plugins;
   loader.load<cslibs_plugins_data::DataProvider, decltype(tf_), decltype(nh)&>(loaded_plugins, tf_, nh);
-  EXPECT_EQ(12ul, loaded_plugins.size());
+  EXPECT_EQ(19ul, loaded_plugins.size());
 }
 
 int main(int argc, char *argv[]) {
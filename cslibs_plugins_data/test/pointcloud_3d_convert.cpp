@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_plugins_data/types/pointcloud_3d_convert.hpp>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace cslibs_plugins_data;
+
+namespace {
+template <typename T>
+sensor_msgs::PointCloud2ConstPtr message(const std::vector<T> &xyz) {
+  sensor_msgs::PointCloud2Ptr msg(new sensor_msgs::PointCloud2);
+  const char *names[] = {"x", "y", "z"};
+  for (uint32_t i = 0; i < 3; ++i) {
+    sensor_msgs::PointField field;
+    field.name = names[i];
+    field.offset = i * sizeof(T);
+    field.datatype = types::detail::point_field_type<T>::value;
+    field.count = 1;
+    msg->fields.emplace_back(field);
+  }
+  msg->height = 1;
+  msg->width = static_cast<uint32_t>(xyz.size() / 3);
+  msg->point_step = 3 * sizeof(T);
+  msg->row_step = msg->width * msg->point_step;
+  msg->is_bigendian = false;
+  msg->is_dense = false;
+  msg->data.resize(xyz.size() * sizeof(T));
+  std::memcpy(msg->data.data(), xyz.data(), msg->data.size());
+  return msg;
+}
+
+/// every third point is valid, the others have NaN or infinite coordinates
+template <typename T>
+std::vector<T> points(const std::size_t n) {
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  const T inf = std::numeric_limits<T>::infinity();
+  const T invalid[][3] = {{nan, 0, 0},     {0, inf, 0}, {0, 0, -inf},
+                          {nan, nan, nan}, {inf, 1, 1}, {inf, -inf, nan}};
+  const std::size_t invalid_size = sizeof(invalid) / sizeof(invalid[0]);
+  std::vector<T> xyz;
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i % 3 == 0) {
+      xyz.insert(xyz.end(), {T(1) + i, T(2), T(3)});
+    } else {
+      /// cycle through every invalid entry independent of the valid stride
+      const T *p = invalid[j++ % invalid_size];
+      xyz.insert(xyz.end(), {p[0], p[1], p[2]});
+    }
+  }
+  return xyz;
+}
+
+template <typename T>
+void expectFinite(const typename cslibs_math_3d::Pointcloud3<T>::ConstPtr &cloud,
+                  const std::size_t expected) {
+  ASSERT_TRUE(static_cast<bool>(cloud));
+  EXPECT_EQ(expected, cloud->size());
+  std::size_t i = 0;
+  for (const auto &p : *cloud) {
+    EXPECT_TRUE(common::isFinite(p(0)));
+    EXPECT_TRUE(common::isFinite(p(1)));
+    EXPECT_TRUE(common::isFinite(p(2)));
+    EXPECT_EQ(T(1) + 3 * i++, p(0));
+  }
+}
+
+template <typename T>
+void testConvert() {
+  const std::size_t n = 3000;
+  const std::size_t expected = n / 3;
+  const types::Pointcloud3View<T> view(message(points<T>(n)));
+
+  typename cslibs_math_3d::Pointcloud3<T>::Ptr dst;
+  types::convert(view, nullptr, dst);
+  expectFinite<T>(dst, expected);
+
+  common::WorkerPool workers(3);
+  types::convert(view, &workers, dst, 100);
+  expectFinite<T>(dst, expected);
+
+  typename types::RangeImage3<T>::Ptr image;
+  types::convert(view, cslibs_math_3d::Transform3<T>(), &workers, dst, 100,
+                 &image);
+  expectFinite<T>(dst, expected);
+
+  /// zero copy consumers rely on the mask of the view
+  expectFinite<T>(view.points(), expected);
+
+  /// an unlimited range must not let infinite points pass
+  const types::Pointcloud3View<T> unlimited(
+      message(points<T>(n)), {0, std::numeric_limits<T>::infinity()});
+  types::convert(unlimited, &workers, dst, 100);
+  expectFinite<T>(dst, expected);
+  expectFinite<T>(unlimited.points(), expected);
+}
+}  // namespace
+
+TEST(Test_cslibs_plugins_data, testConvertDropsNonFinitePoints) {
+  testConvert<float>();
+  testConvert<double>();
+}
+
+TEST(Test_cslibs_plugins_data, testIsFinite) {
+  EXPECT_TRUE(common::isFinite(0.0f));
+  EXPECT_TRUE(common::isFinite(-std::numeric_limits<double>::max()));
+  EXPECT_TRUE(common::isFinite(std::numeric_limits<float>::denorm_min()));
+  EXPECT_FALSE(common::isFinite(std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_FALSE(common::isFinite(-std::numeric_limits<float>::infinity()));
+  EXPECT_FALSE(common::isFinite(std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_FALSE(common::isFinite(std::numeric_limits<double>::infinity()));
+}
+
+int main(int argc, char *argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_plugins_data/recording/log_reader.hpp>
+#include <cslibs_plugins_data/recording/log_writer.hpp>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace cslibs_plugins_data;
+
+namespace {
+class TemporaryLog {
+ public:
+  TemporaryLog() {
+    char path[] = "/tmp/cslibs_plugins_data_test_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    path_ = path;
+  }
+
+  ~TemporaryLog() { std::remove(path_.c_str()); }
+
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+cslibs_time::TimeFrame timeFrame(const int64_t ns) {
+  return cslibs_time::TimeFrame(cslibs_time::Time(ns),
+                                cslibs_time::Time(ns + 10));
+}
+
+template <typename T>
+typename types::Laserscan2<T>::Ptr laserscan(const bool intensities,
+                                             const bool echoes) {
+  using point_t = typename types::Laserscan2<T>::point_t;
+  typename types::Laserscan2<T>::Ptr scan(new types::Laserscan2<T>(
+      "laser", timeFrame(100), {0.1, 30.0}, {-1.5, 1.5},
+      cslibs_time::Time(120)));
+  for (int i = 0; i < 5; ++i) {
+    scan->insert(T(0.1) * i, T(1) + i, point_t(T(1) + i, T(0.5) * i),
+                 point_t(T(0.1), T(0.2)));
+    if (intensities) {
+      scan->insertIntensity(T(10) * i);
+    }
+  }
+  if (echoes) {
+    for (int b = 0; b < 5; ++b) {
+      for (int e = 0; e < b % 3; ++e) {
+        scan->insertEcho(T(0.1) * b, T(2) + e, point_t(T(2) + e, T(b)));
+        if (intensities) {
+          scan->insertEchoIntensity(T(20) * b + e);
+        }
+      }
+      scan->closeBeam();
+    }
+  }
+  return scan;
+}
+
+template <typename T>
+void expectEqualRays(const typename types::Laserscan2<T>::rays_t &a,
+                     const typename types::Laserscan2<T>::rays_t &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].angle, b[i].angle);
+    EXPECT_EQ(a[i].range, b[i].range);
+    EXPECT_EQ(a[i].end_point(0), b[i].end_point(0));
+    EXPECT_EQ(a[i].end_point(1), b[i].end_point(1));
+    EXPECT_EQ(a[i].start_point(0), b[i].start_point(0));
+    EXPECT_EQ(a[i].start_point(1), b[i].start_point(1));
+  }
+}
+
+void expectEqualHeader(const Data &a, const Data &b) {
+  EXPECT_EQ(a.frame(), b.frame());
+  EXPECT_EQ(a.timeFrame().start.nanoseconds(),
+            b.timeFrame().start.nanoseconds());
+  EXPECT_EQ(a.timeFrame().end.nanoseconds(), b.timeFrame().end.nanoseconds());
+  EXPECT_EQ(a.stampReceived().nanoseconds(), b.stampReceived().nanoseconds());
+}
+
+template <typename T>
+void testLaserscan(const bool intensities, const bool echoes) {
+  TemporaryLog log;
+  const auto scan = laserscan<T>(intensities, echoes);
+  {
+    recording::LogWriter writer(log.path());
+    ASSERT_TRUE(writer.write(*scan));
+  }
+
+  recording::LogReader reader(log.path());
+  Data::ConstPtr data;
+  ASSERT_TRUE(reader.next(data));
+  ASSERT_TRUE(data->isType<types::Laserscan2<T>>());
+  const auto &read = data->as<types::Laserscan2<T>>();
+  expectEqualHeader(*scan, read);
+  EXPECT_EQ(scan->getLinearMin(), read.getLinearMin());
+  EXPECT_EQ(scan->getLinearMax(), read.getLinearMax());
+  EXPECT_EQ(scan->getAngularMin(), read.getAngularMin());
+  EXPECT_EQ(scan->getAngularMax(), read.getAngularMax());
+  expectEqualRays<T>(scan->getRays(), read.getRays());
+
+  EXPECT_EQ(intensities, read.hasIntensities());
+  EXPECT_EQ(scan->getIntensities(), read.getIntensities());
+  EXPECT_EQ(echoes, read.hasEchoes());
+  EXPECT_EQ(scan->getEchoOffsets(), read.getEchoOffsets());
+  expectEqualRays<T>(scan->getAllEchoes(), read.getAllEchoes());
+  EXPECT_EQ(intensities && echoes, read.hasEchoIntensities());
+  EXPECT_EQ(scan->getAllEchoIntensities(), read.getAllEchoIntensities());
+  EXPECT_FALSE(reader.next(data));
+}
+
+template <typename T>
+void testOdometry() {
+  using transform_t = typename types::Odometry2<T>::transform_t;
+  TemporaryLog log;
+  const types::Odometry2<T> odometry("odom", timeFrame(200),
+                                     transform_t(1, 2, 0.3),
+                                     transform_t(4, 5, -0.6),
+                                     cslibs_time::Time(230));
+  {
+    recording::LogWriter writer(log.path());
+    ASSERT_TRUE(writer.write(odometry));
+  }
+
+  recording::LogReader reader(log.path());
+  Data::ConstPtr data;
+  ASSERT_TRUE(reader.next(data));
+  ASSERT_TRUE(data->isType<types::Odometry2<T>>());
+  const auto &read = data->as<types::Odometry2<T>>();
+  expectEqualHeader(odometry, read);
+  EXPECT_EQ(odometry.getStartPose().tx(), read.getStartPose().tx());
+  EXPECT_EQ(odometry.getStartPose().ty(), read.getStartPose().ty());
+  EXPECT_NEAR(odometry.getStartPose().yaw(), read.getStartPose().yaw(), 1e-6);
+  EXPECT_EQ(odometry.getEndPose().tx(), read.getEndPose().tx());
+  EXPECT_EQ(odometry.getEndPose().ty(), read.getEndPose().ty());
+  EXPECT_NEAR(odometry.getEndPose().yaw(), read.getEndPose().yaw(), 1e-6);
+  EXPECT_FALSE(reader.next(data));
+}
+
+template <template <typename> class Pointcloud, typename T, typename Point>
+void testPointcloud(const std::size_t dim) {
+  using cloud_t = typename Pointcloud<T>::cloud_t;
+  TemporaryLog log;
+  Pointcloud<T> pointcloud("cloud", timeFrame(300), cslibs_time::Time(310));
+  pointcloud.points().reset(new cloud_t);
+  for (int i = 0; i < 10; ++i) {
+    Point p;
+    for (std::size_t d = 0; d < dim; ++d) {
+      p(d) = T(0.5) * i + d;
+    }
+    pointcloud.points()->insert(p);
+  }
+  {
+    recording::LogWriter writer(log.path());
+    ASSERT_TRUE(writer.write(pointcloud));
+  }
+
+  recording::LogReader reader(log.path());
+  Data::ConstPtr data;
+  ASSERT_TRUE(reader.next(data));
+  ASSERT_TRUE(data->isType<Pointcloud<T>>());
+  const auto &read = data->as<Pointcloud<T>>();
+  expectEqualHeader(pointcloud, read);
+  ASSERT_TRUE(static_cast<bool>(read.points()));
+  ASSERT_EQ(pointcloud.points()->size(), read.points()->size());
+  auto it = read.points()->begin();
+  for (const auto &p : *pointcloud.points()) {
+    for (std::size_t d = 0; d < dim; ++d) {
+      EXPECT_EQ(p(d), (*it)(d));
+    }
+    ++it;
+  }
+  EXPECT_FALSE(reader.next(data));
+}
+
+types::Odometry2<double> odometryReceived(const int64_t ns) {
+  using transform_t = types::Odometry2<double>::transform_t;
+  return types::Odometry2<double>("odom", timeFrame(ns), transform_t(),
+                                  transform_t(static_cast<double>(ns), 0, 0),
+                                  cslibs_time::Time(ns));
+}
+}  // namespace
+
+TEST(Test_cslibs_plugins_data, testRecordingLaserscan) {
+  testLaserscan<double>(true, true);
+  testLaserscan<float>(true, true);
+  testLaserscan<double>(true, false);
+  testLaserscan<float>(false, true);
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingLaserscanWithoutSections) {
+  testLaserscan<double>(false, false);
+  testLaserscan<float>(false, false);
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingOdometry) {
+  testOdometry<double>();
+  testOdometry<float>();
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingPointcloud) {
+  testPointcloud<types::Pointcloud2, double, cslibs_math_2d::Point2<double>>(2);
+  testPointcloud<types::Pointcloud2, float, cslibs_math_2d::Point2<float>>(2);
+  testPointcloud<types::Pointcloud3, double, cslibs_math_3d::Point3<double>>(3);
+  testPointcloud<types::Pointcloud3, float, cslibs_math_3d::Point3<float>>(3);
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingRecoverWithoutIndex) {
+  TemporaryLog log;
+  recording::LogWriter::Options options;
+  options.chunk_size = 256;
+  recording::LogWriter writer(log.path(), options);
+  for (int64_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(writer.write(odometryReceived(i)));
+  }
+  /// the index is only written on close, all flushed chunks are recovered
+  writer.flush();
+
+  recording::LogReader reader(log.path());
+  EXPECT_GT(reader.chunks(), 1ul);
+  EXPECT_EQ(100ul, reader.records());
+  EXPECT_EQ(0, reader.startStamp());
+  EXPECT_EQ(99, reader.endStamp());
+
+  Data::ConstPtr data;
+  int64_t expected = 0;
+  while (reader.next(data)) {
+    EXPECT_EQ(expected++, data->stampReceived().nanoseconds());
+  }
+  EXPECT_EQ(100, expected);
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingSeekUnordered) {
+  TemporaryLog log;
+  recording::LogWriter::Options options;
+  options.chunk_size = 1;
+  /// providers are recorded as their data arrives, chunks overlap in time
+  const int64_t stamps[] = {50, 10, 20, 30, 40, 60};
+  {
+    recording::LogWriter writer(log.path(), options);
+    for (const int64_t stamp : stamps) {
+      ASSERT_TRUE(writer.write(odometryReceived(stamp)));
+    }
+  }
+
+  recording::LogReader reader(log.path());
+  ASSERT_EQ(6ul, reader.chunks());
+  EXPECT_EQ(10, reader.startStamp());
+  EXPECT_EQ(60, reader.endStamp());
+
+  Data::ConstPtr data;
+  reader.seek(45);
+  ASSERT_TRUE(reader.next(data));
+  EXPECT_EQ(50, data->stampReceived().nanoseconds());
+  ASSERT_TRUE(reader.next(data));
+  EXPECT_EQ(10, data->stampReceived().nanoseconds());
+
+  reader.seek(55);
+  ASSERT_TRUE(reader.next(data));
+  EXPECT_EQ(60, data->stampReceived().nanoseconds());
+
+  reader.seek(80);
+  EXPECT_FALSE(reader.next(data));
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingWriteFailure) {
+  recording::LogWriter::Options options;
+  options.chunk_size = 1;
+  recording::LogWriter writer("/dev/full", options);
+  bool written = true;
+  for (int64_t i = 0; i < 10000 && written; ++i) {
+    written = writer.write(odometryReceived(i));
+  }
+  EXPECT_FALSE(written);
+  EXPECT_TRUE(writer.failed());
+}
+
+TEST(Test_cslibs_plugins_data, testRecordingSkipLongFrame) {
+  using transform_t = types::Odometry2<double>::transform_t;
+  TemporaryLog log;
+  {
+    recording::LogWriter writer(log.path());
+    const types::Odometry2<double> odometry(
+        std::string(70000, 'f'), timeFrame(10), transform_t(), transform_t(),
+        cslibs_time::Time(10));
+    EXPECT_FALSE(writer.write(odometry));
+    EXPECT_EQ(1ul, writer.skipped());
+    EXPECT_TRUE(writer.write(odometryReceived(20)));
+    EXPECT_FALSE(writer.failed());
+  }
+
+  recording::LogReader reader(log.path());
+  Data::ConstPtr data;
+  ASSERT_TRUE(reader.next(data));
+  EXPECT_EQ(20, data->stampReceived().nanoseconds());
+  EXPECT_FALSE(reader.next(data));
+}
+
+int main(int argc, char *argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}